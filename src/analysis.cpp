@@ -0,0 +1,265 @@
+#include "analysis.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+
+using namespace chip_8;
+
+namespace {
+uint16_t constexpr PROGRAM_START = Cpu::MEMORY_SIZE - Cpu::PROGRAM_SIZE;
+
+bool is_skip(Opcode const &opcode) {
+  switch (opcode.a()) {
+  case 0x3:
+  case 0x4:
+  case 0x5:
+  case 0x9:
+  case 0xE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool falls_through(Opcode const &opcode) {
+  switch (opcode.a()) {
+  case 0x0:
+    return opcode.nnn() != 0x0EE;
+  case 0x1:
+  case 0x2:
+  case 0xB:
+    return false;
+  default:
+    return true;
+  }
+}
+
+bool changes_index(Opcode const &opcode) {
+  if (opcode.a() == 0xA || opcode.a() == 0xB) {
+    return true;
+  }
+
+  return opcode.a() == 0xF &&
+         (opcode.nn() == 0x1E || opcode.nn() == 0x29 || opcode.nn() == 0x55 ||
+          opcode.nn() == 0x65);
+}
+
+bool uses_index(Opcode const &opcode) {
+  return opcode.a() == 0xD ||
+         (opcode.a() == 0xF && (opcode.nn() == 0x1E || opcode.nn() == 0x33 ||
+                                opcode.nn() == 0x55 || opcode.nn() == 0x65));
+}
+
+class Image {
+public:
+  explicit Image(std::span<uint8_t const> program) noexcept
+      : _end(PROGRAM_START + std::min(program.size(), Cpu::PROGRAM_SIZE)) {
+    std::ranges::copy(program.first(_end - PROGRAM_START),
+                      _memory.begin() + PROGRAM_START);
+  }
+
+  // Only the loaded program is traced; running off it executes padding
+  [[nodiscard]]
+  std::optional<Opcode> at(size_t location) const noexcept {
+    if (location < PROGRAM_START || location + 1 >= _end) {
+      return std::nullopt;
+    }
+
+    return Opcode{_memory[location], _memory[location + 1]};
+  }
+
+private:
+  size_t _end;
+  std::array<uint8_t, Cpu::MEMORY_SIZE> _memory{};
+};
+} // namespace
+
+std::string chip_8::pattern(Opcode const &opcode) {
+  switch (opcode.a()) {
+  case 0x0:
+    return opcode.nnn() == 0x0E0   ? "00E0"
+           : opcode.nnn() == 0x0EE ? "00EE"
+                                   : "0NNN";
+  case 0x1:
+  case 0x2:
+  case 0xA:
+  case 0xB:
+    return hex(opcode.a(), 1) + "NNN";
+  case 0x3:
+  case 0x4:
+  case 0x6:
+  case 0x7:
+  case 0xC:
+    return hex(opcode.a(), 1) + "XNN";
+  case 0x5:
+  case 0x8:
+  case 0x9:
+    return hex(opcode.a(), 1) + "XY" + hex(opcode.n(), 1);
+  case 0xD:
+    return "DXYN";
+  default:
+    return hex(opcode.a(), 1) + "X" + hex(opcode.nn(), 2);
+  }
+}
+
+Analysis chip_8::analyse(std::span<uint8_t const> program, size_t max_ngram) {
+  Analysis analysis;
+  Image image{program};
+
+  std::bitset<Cpu::MEMORY_SIZE> legal, targets;
+  std::deque<uint16_t> pending{PROGRAM_START};
+  targets[PROGRAM_START] = true;
+
+  auto visit = [&](size_t location, bool target) {
+    if (location < Cpu::MEMORY_SIZE) {
+      targets[location] = targets[location] || target;
+      if (!analysis.reachable[location]) {
+        pending.push_back(location);
+      }
+    }
+  };
+
+  while (!pending.empty()) {
+    auto location = pending.front();
+    pending.pop_front();
+    if (analysis.reachable[location]) {
+      continue;
+    }
+    analysis.reachable[location] = true;
+
+    auto opcode = image.at(location);
+    if (!opcode || !decode(*opcode)) {
+      analysis.illegal.push_back(
+          {location, opcode ? opcode->value() : uint16_t{0}});
+      continue;
+    }
+    legal[location] = true;
+
+    analysis.opcodes[pattern(*opcode)]++;
+
+    if (falls_through(*opcode)) {
+      visit(location + 2, false);
+    }
+    if (is_skip(*opcode)) {
+      visit(location + 4, true);
+    }
+    if (opcode->a() == 0x1 || opcode->a() == 0x2) {
+      visit(opcode->nnn(), true);
+    }
+    if (opcode->a() == 0x2) {
+      visit(location + 2, true);
+    }
+    if (opcode->a() == 0xB) {
+      analysis.indirect_jumps.push_back({location, opcode->value()});
+    }
+  }
+
+  auto code = [&](size_t location) {
+    return location < Cpu::MEMORY_SIZE && legal[location];
+  };
+
+  // Straight-line predecessor, if the only way into location is by falling
+  // through from the previous instruction
+  auto previous = [&](size_t location) -> std::optional<Opcode> {
+    if (location < 2 || targets[location] || !code(location - 2)) {
+      return std::nullopt;
+    }
+
+    auto opcode = *image.at(location - 2);
+    return falls_through(opcode) ? std::optional{opcode} : std::nullopt;
+  };
+
+  bool shift = false, logic = false, load_store = false, jump = false,
+       sys = false;
+
+  for (size_t location = 0; location < Cpu::MEMORY_SIZE; location++) {
+    if (!code(location)) {
+      continue;
+    }
+    auto opcode = *image.at(location);
+
+    std::string ngram = pattern(opcode);
+    auto next = location;
+    for (size_t n = 2; n <= max_ngram; n++) {
+      if (!falls_through(*image.at(next)) || !code(next + 2)) {
+        break;
+      }
+      next += 2;
+      ngram += " " + pattern(*image.at(next));
+      analysis.ngrams[ngram]++;
+    }
+
+    switch (opcode.a()) {
+    case 0x0:
+      sys |= opcode.nnn() != 0x0E0 && opcode.nnn() != 0x0EE;
+      break;
+    case 0x8:
+      shift |= (opcode.n() == 0x6 || opcode.n() == 0xE) &&
+               opcode.x() != opcode.y();
+      logic |= opcode.n() >= 0x1 && opcode.n() <= 0x3;
+      break;
+    case 0xB:
+      jump = true;
+      break;
+    case 0xF:
+      if (opcode.nn() == 0x55 || opcode.nn() == 0x65) {
+        auto following = location + 2;
+        for (; code(following) && !targets[following]; following += 2) {
+          auto after = *image.at(following);
+          if (changes_index(after) && !uses_index(after)) {
+            break;
+          }
+          if (uses_index(after)) {
+            load_store = true;
+            break;
+          }
+          if (!falls_through(after)) {
+            break;
+          }
+        }
+      }
+
+      if (opcode.nn() == 0x33 || opcode.nn() == 0x55) {
+        WriteSite site{uint16_t(location), opcode.value(), std::nullopt};
+        for (auto before = location; auto preceding = previous(before);
+             before -= 2) {
+          if (preceding->a() == 0xA) {
+            site.target = preceding->nnn();
+            break;
+          }
+          if (changes_index(*preceding)) {
+            break;
+          }
+        }
+
+        if (site.target) {
+          size_t size = opcode.nn() == 0x33 ? 3 : opcode.x() + 1;
+          for (size_t i = std::max(*site.target, uint16_t{1}) - 1;
+               i < *site.target + size; i++) {
+            site.overwrites_code |= code(i);
+          }
+        }
+
+        if (!site.target || site.overwrites_code) {
+          analysis.writes.push_back(site);
+        }
+      }
+      break;
+    }
+  }
+
+  for (auto [name, used] : {std::pair{"shift", shift},
+                            {"logic", logic},
+                            {"load_store", load_store},
+                            {"jump", jump},
+                            {"sys", sys}}) {
+    if (used) {
+      analysis.quirks.emplace_back(name);
+    }
+  }
+
+  return analysis;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "cpu.hpp"
+#include "opcode.hpp"
+
+#include <bitset>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace chip_8 {
+
+struct Site {
+  uint16_t location;
+  uint16_t opcode;
+};
+
+struct WriteSite {
+  uint16_t location;
+  uint16_t opcode;
+  std::optional<uint16_t> target;
+  bool overwrites_code = false;
+};
+
+struct Analysis {
+  std::bitset<Cpu::MEMORY_SIZE> reachable;
+  std::map<std::string, size_t> opcodes;
+  std::map<std::string, size_t> ngrams;
+  std::vector<Site> illegal;
+  std::vector<Site> indirect_jumps;
+  std::vector<WriteSite> writes;
+  std::vector<std::string> quirks;
+};
+
+[[nodiscard]]
+std::string pattern(Opcode const &opcode);
+
+[[nodiscard]]
+Analysis analyse(std::span<uint8_t const> program, size_t max_ngram = 3);
+} // namespace chip_8
@@ -0,0 +1,141 @@
+#include "capture.hpp"
+
+#include <utility>
+
+using namespace chip_8;
+
+namespace {
+void write_le(std::ostream &ostream, uint32_t value, size_t size) {
+  for (size_t i = 0; i < size; i++, value >>= 8) {
+    ostream.put(char(value & 0xFF));
+  }
+}
+
+CaptureFrame capture_frame(Cpu const &cpu, uint64_t frame) noexcept {
+  return {frame, cpu.screen.rows(),
+          cpu.timers[std::to_underlying(Timer::SOUND)] != 0};
+}
+} // namespace
+
+Capture::Capture(std::ofstream video, std::ofstream audio)
+    : _video(std::move(video)), _audio(std::move(audio)) {
+  _video << "YUV4MPEG2 W" << Screen::WIDTH << " H" << Screen::HEIGHT << " F"
+         << _FRAMES_PER_SECOND << ":1 Ip A1:1 Cmono\n";
+
+  _audio.write("RIFF", 4);
+  write_le(_audio, 0, 4);
+  _audio.write("WAVEfmt ", 8);
+  write_le(_audio, 16, 4);
+  write_le(_audio, 1, 2);
+  write_le(_audio, 1, 2);
+  write_le(_audio, SAMPLE_RATE, 4);
+  write_le(_audio, SAMPLE_RATE * sizeof(int16_t), 4);
+  write_le(_audio, sizeof(int16_t), 2);
+  write_le(_audio, 16, 2);
+  _audio.write("data", 4);
+  write_le(_audio, 0, 4);
+
+  _writer = std::jthread{[this](std::stop_token stop) { _write(stop); }};
+}
+
+Capture::~Capture() noexcept {
+  _writer.request_stop();
+  _pushes.fetch_add(1, std::memory_order_release);
+  _pushes.notify_one();
+  _writer.join();
+}
+
+std::unique_ptr<Capture> Capture::open(std::filesystem::path const &prefix) {
+  auto video_path = prefix, audio_path = prefix;
+  std::ofstream video{video_path += ".y4m", std::ios::binary};
+  std::ofstream audio{audio_path += ".wav", std::ios::binary};
+  if (!video || !audio) {
+    return nullptr;
+  }
+
+  return std::unique_ptr<Capture>{
+      new Capture{std::move(video), std::move(audio)}};
+}
+
+// Frames equal to the last queued one are left for the writer to repeat, so
+// static screens cost nothing and the queue only fills on real changes
+bool Capture::push(Cpu const &cpu, uint64_t frame) noexcept {
+  auto captured = capture_frame(cpu, frame);
+  _end.store(frame + 1, std::memory_order_relaxed);
+  if (_queued && _queued->rows == captured.rows &&
+      _queued->sound == captured.sound) {
+    return true;
+  }
+
+  if (!_queue.push(captured)) {
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  _queued = captured;
+
+  _pushes.fetch_add(1, std::memory_order_release);
+  _pushes.notify_one();
+  return true;
+}
+
+void Capture::_write(std::stop_token stop) {
+  while (true) {
+    auto pushes = _pushes.load(std::memory_order_acquire);
+    if (auto frame = _queue.pop()) {
+      if (_last && frame->frame > _last->frame) {
+        for (auto gap = _last->frame + 1; gap < frame->frame; gap++) {
+          _write_frame(*_last);
+        }
+      }
+
+      _write_frame(*frame);
+      _last = frame;
+    } else if (stop.stop_requested()) {
+      break;
+    } else {
+      _pushes.wait(pushes, std::memory_order_acquire);
+    }
+  }
+
+  if (_last) {
+    auto end = _end.load(std::memory_order_relaxed);
+    for (auto gap = _last->frame + 1; gap < end; gap++) {
+      _write_frame(*_last);
+    }
+  }
+
+  _finish();
+}
+
+void Capture::_write_frame(CaptureFrame const &frame) {
+  std::array<char, Screen::WIDTH * Screen::HEIGHT> luma;
+  for (size_t y = 0; y < Screen::HEIGHT; y++) {
+    for (size_t x = 0; x < Screen::WIDTH; x++) {
+      luma[y * Screen::WIDTH + x] = frame.rows[y] >> x & 1 ? '\xFF' : '\0';
+    }
+  }
+
+  _video << "FRAME\n";
+  _video.write(luma.data(), luma.size());
+
+  std::array<char, _SAMPLES_PER_FRAME * sizeof(int16_t)> samples;
+  for (size_t i = 0; i < _SAMPLES_PER_FRAME; i++, _samples++) {
+    bool high = _samples * TONE * 2 / SAMPLE_RATE % 2;
+    int16_t sample = frame.sound ? (high ? _AMPLITUDE : -_AMPLITUDE) : 0;
+
+    samples[2 * i] = char(sample & 0xFF);
+    samples[2 * i + 1] = char(sample >> 8 & 0xFF);
+  }
+  _audio.write(samples.data(), samples.size());
+}
+
+void Capture::_finish() noexcept {
+  _video.flush();
+
+  uint32_t data = _samples * sizeof(int16_t);
+  _audio.seekp(4);
+  write_le(_audio, 36 + data, 4);
+  _audio.seekp(40);
+  write_le(_audio, data, 4);
+  _audio.flush();
+}
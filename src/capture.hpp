@@ -0,0 +1,71 @@
+#pragma once
+
+#include "cpu.hpp"
+#include "screen.hpp"
+#include "spsc_queue.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <thread>
+
+namespace chip_8 {
+
+struct CaptureFrame {
+  uint64_t frame;
+  std::array<uint64_t, Screen::HEIGHT> rows;
+  bool sound;
+};
+
+class Capture {
+public:
+  ~Capture() noexcept;
+
+  [[nodiscard]]
+  static std::unique_ptr<Capture> open(std::filesystem::path const &prefix);
+
+  bool push(Cpu const &cpu, uint64_t frame) noexcept;
+
+  [[nodiscard]]
+  uint64_t dropped() const noexcept {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+
+  size_t static constexpr QUEUE_SIZE = 0x1000;
+  uint32_t static constexpr SAMPLE_RATE = 44100;
+  uint32_t static constexpr TONE = 440;
+
+private:
+  Capture(std::ofstream video, std::ofstream audio);
+
+  void _write(std::stop_token stop);
+
+  void _write_frame(CaptureFrame const &frame);
+
+  void _finish() noexcept;
+
+  uint32_t static constexpr _FRAMES_PER_SECOND = 60;
+  uint32_t static constexpr _SAMPLES_PER_FRAME =
+      SAMPLE_RATE / _FRAMES_PER_SECOND;
+  int16_t static constexpr _AMPLITUDE = 0x2000;
+
+  std::ofstream _video;
+  std::ofstream _audio;
+  uint64_t _samples = 0;
+  std::optional<CaptureFrame> _last;
+
+  std::optional<CaptureFrame> _queued;
+  std::atomic<uint64_t> _end = 0;
+
+  SpscQueue<CaptureFrame, QUEUE_SIZE> _queue;
+  std::atomic<uint32_t> _pushes = 0;
+  std::atomic<uint64_t> _dropped = 0;
+
+  std::jthread _writer;
+};
+} // namespace chip_8
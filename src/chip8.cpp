@@ -0,0 +1,174 @@
+#include "chip8.h"
+#include "emulator.hpp"
+
+#include <algorithm>
+#include <barrier>
+#include <memory>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+using namespace chip_8;
+
+static_assert(CHIP8_WIDTH == Screen::WIDTH && CHIP8_HEIGHT == Screen::HEIGHT);
+
+struct chip8_batch {
+  chip8_batch(std::span<uint8_t const> rom, size_t n)
+      : initial(rom), emulators(n), rewards(n), dones(n),
+        observations(n * Screen::WIDTH * Screen::HEIGHT),
+        _workers_size(std::clamp<size_t>(std::thread::hardware_concurrency(),
+                                         1, std::max<size_t>(n, 1))),
+        _start(_workers_size), _finish(_workers_size) {
+    for (auto &&emulator : emulators) {
+      emulator.cpu = initial;
+    }
+    for (size_t i = 0; i < n; i++) {
+      observe(i);
+    }
+
+    try {
+      for (size_t worker = 1; worker < _workers_size; worker++) {
+        _workers.emplace_back([this, worker] {
+          while (true) {
+            _start.arrive_and_wait();
+            if (_stopping) {
+              return;
+            }
+            work(worker);
+            _finish.arrive_and_wait();
+          }
+        });
+      }
+    } catch (...) {
+      // Arrive for the workers that never started so the ones that did can
+      // stop and be joined
+      _stopping = true;
+      static_cast<void>(_start.arrive(_workers_size - _workers.size()));
+      throw;
+    }
+  }
+
+  ~chip8_batch() {
+    _stopping = true;
+    _start.arrive_and_wait();
+  }
+
+  void step(uint16_t const *actions, size_t frames) {
+    _actions = actions;
+    _frames = frames;
+
+    _start.arrive_and_wait();
+    work(0);
+    _finish.arrive_and_wait();
+  }
+
+  void reset(size_t i) noexcept {
+    emulators[i].cpu = initial;
+    rewards[i] = 0;
+    dones[i] = false;
+    observe(i);
+  }
+
+  void observe(size_t i) noexcept {
+    auto rows = emulators[i].cpu.screen.rows();
+    auto pixels = observations.begin() + i * Screen::WIDTH * Screen::HEIGHT;
+
+    for (auto row : rows) {
+      for (size_t x = 0; x < Screen::WIDTH; x++) {
+        *pixels++ = row >> x & 1;
+      }
+    }
+  }
+
+  Cpu initial;
+  std::vector<Emulator> emulators;
+  std::vector<float> rewards;
+  std::vector<uint8_t> dones;
+  std::vector<uint8_t> observations;
+  std::optional<uint16_t> reward_address;
+
+private:
+  void work(size_t worker) noexcept {
+    auto n = emulators.size();
+    for (auto i = worker * n / _workers_size;
+         i < (worker + 1) * n / _workers_size; i++) {
+      auto &&emulator = emulators[i];
+      auto &&cpu = emulator.cpu;
+
+      for (size_t key = 0; key < cpu.keyboard.size(); key++) {
+        cpu.keyboard[key] = _actions && _actions[i] >> key & 1;
+      }
+
+      auto score = reward_address ? cpu.memory[*reward_address] : 0;
+      auto illegal_opcodes = emulator.illegal_opcodes;
+
+      for (size_t frame = 0; frame < _frames; frame++) {
+        emulator.run_frame();
+      }
+
+      rewards[i] = reward_address ? cpu.memory[*reward_address] - score : 0;
+      dones[i] |= emulator.illegal_opcodes != illegal_opcodes ||
+                  cpu.trap != Trap::NONE;
+      observe(i);
+    }
+  }
+
+  size_t _workers_size;
+  std::barrier<> _start;
+  std::barrier<> _finish;
+  std::vector<std::jthread> _workers;
+  bool _stopping = false;
+
+  uint16_t const *_actions = nullptr;
+  size_t _frames = 0;
+};
+
+chip8_batch *chip8_create_batch(uint8_t const *rom, size_t size, size_t n) {
+  if (!rom || size > Cpu::PROGRAM_SIZE) {
+    return nullptr;
+  }
+
+  try {
+    return new chip8_batch{{rom, size}, n};
+  } catch (std::exception const &) {
+    return nullptr;
+  }
+}
+
+void chip8_destroy_batch(chip8_batch *batch) { delete batch; }
+
+size_t chip8_batch_size(chip8_batch const *batch) {
+  return batch->emulators.size();
+}
+
+void chip8_step_batch(chip8_batch *batch, uint16_t const *actions,
+                      size_t frames) {
+  batch->step(actions, frames);
+}
+
+void chip8_reset_batch(chip8_batch *batch, uint8_t const *mask) {
+  for (size_t i = 0; i < batch->emulators.size(); i++) {
+    if (!mask || mask[i]) {
+      batch->reset(i);
+    }
+  }
+}
+
+void chip8_set_reward_address(chip8_batch *batch, uint16_t address) {
+  if (address < batch->initial.memory.size()) {
+    batch->reward_address = address;
+  }
+}
+
+uint8_t const *chip8_observations(chip8_batch const *batch) {
+  return batch->observations.data();
+}
+
+float const *chip8_rewards(chip8_batch const *batch) {
+  return batch->rewards.data();
+}
+
+uint8_t const *chip8_dones(chip8_batch const *batch) {
+  return batch->dones.data();
+}
@@ -0,0 +1,45 @@
+#ifndef CHIP_8_H
+#define CHIP_8_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHIP8_WIDTH 64
+#define CHIP8_HEIGHT 32
+
+typedef struct chip8_batch chip8_batch;
+
+/* Returns NULL if the ROM does not fit in memory or allocation fails. */
+chip8_batch *chip8_create_batch(uint8_t const *rom, size_t size, size_t n);
+
+void chip8_destroy_batch(chip8_batch *batch);
+
+size_t chip8_batch_size(chip8_batch const *batch);
+
+/* actions[i] is a bitmask of the keys held by environment i. */
+void chip8_step_batch(chip8_batch *batch, uint16_t const *actions,
+                      size_t frames);
+
+/* Resets every environment i with mask[i] != 0, or all if mask is NULL. */
+void chip8_reset_batch(chip8_batch *batch, uint8_t const *mask);
+
+/* Rewards become the change of the byte at address over each step. */
+void chip8_set_reward_address(chip8_batch *batch, uint16_t address);
+
+/* n * CHIP8_HEIGHT * CHIP8_WIDTH bytes, row-major, 1 for a lit pixel. */
+uint8_t const *chip8_observations(chip8_batch const *batch);
+
+float const *chip8_rewards(chip8_batch const *batch);
+
+/* Set once an environment executes an illegal opcode or traps, until reset. */
+uint8_t const *chip8_dones(chip8_batch const *batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
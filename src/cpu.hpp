@@ -1,24 +1,45 @@
 #pragma once
 
+#include "mix.hpp"
 #include "screen.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cassert>
 #include <cstdint>
 #include <optional>
 #include <ranges>
-#include <stdexcept>
-#include <vector>
+#include <type_traits>
+#include <utility>
 
 namespace chip_8 {
 
 enum class Timer { DELAY, SOUND };
 
-class Cpu {
+enum class Trap : uint8_t {
+  NONE,
+  STACK_OVERFLOW,
+  STACK_UNDERFLOW,
+  OUT_OF_BOUNDS,
+  BREAKPOINT,
+  WATCHPOINT,
+};
+
+class alignas(64) Cpu {
 public:
   constexpr Cpu() noexcept = default;
 
   constexpr Cpu(std::ranges::input_range auto &&program) {
-    std::ranges::move(program, memory.begin() + _PROGRAM_START);
+    if constexpr (std::ranges::sized_range<decltype(program)>) {
+      assert(std::ranges::size(program) <= PROGRAM_SIZE);
+    }
+
+    std::ranges::move(program | std::views::take(PROGRAM_SIZE),
+                      memory.begin() + _PROGRAM_START);
+    for (size_t location = _PROGRAM_START; location < memory.size();
+         location++) {
+      memory_fingerprint ^= _key(location, memory[location]);
+    }
   }
 
   constexpr ~Cpu() noexcept = default;
@@ -26,15 +47,15 @@ public:
   template <typename T>
   [[nodiscard]]
   std::optional<T> constexpr fetch(size_t location) const noexcept {
-    T result = 0;
-    try {
-      for (size_t i = 0; i < sizeof(T); i++) {
-        result = result << 8 | memory.at(location + i);
-      }
-      return result;
-    } catch (std::out_of_range const &ex) {
+    if (location + sizeof(T) > memory.size()) {
       return std::nullopt;
     }
+
+    T result = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+      result = result << 8 | memory[location + i];
+    }
+    return result;
   }
 
   void constexpr step_program_counter(ssize_t amount = 1) noexcept {
@@ -43,7 +64,7 @@ public:
 
   void constexpr decrease_timers() noexcept {
     for (auto &&timer : timers) {
-      timer = std::min(0, timer - 1);
+      timer = std::max(0, timer - 1);
     }
   }
 
@@ -51,7 +72,97 @@ public:
     registers[_REGISTER_FLAG] = flag;
   }
 
+  void constexpr write(size_t location, uint8_t value) noexcept {
+    memory_fingerprint ^=
+        _key(location, memory[location]) ^ _key(location, value);
+    memory[location] = value;
+  }
+
+  [[nodiscard]]
+  uint64_t constexpr fingerprint() const noexcept {
+    auto fingerprint = mix(memory_fingerprint ^ mix(screen.fingerprint()));
+    auto combine = [&](uint64_t value) {
+      fingerprint = mix(fingerprint ^ value);
+    };
+
+    combine(program_counter | uint64_t{index} << 16 |
+            uint64_t{stack_pointer} << 32 |
+            uint64_t{std::to_underlying(trap)} << 40 |
+            uint64_t{key_wait.value_or(0xFF)} << 48);
+    combine(cycles | uint64_t{timers[0]} << 32 | uint64_t{timers[1]} << 40);
+    for (size_t i = 0; i < registers.size(); i += 8) {
+      uint64_t word = 0;
+      for (size_t j = 0; j < 8; j++) {
+        word |= uint64_t{registers[i + j]} << 8 * j;
+      }
+      combine(word);
+    }
+    for (size_t i = 0; i < stack_pointer; i++) {
+      combine(stack[i]);
+    }
+
+    return fingerprint;
+  }
+
+  [[nodiscard]]
+  bool constexpr check_memory(size_t location, size_t size) noexcept {
+    if (location + size > memory.size()) {
+      trap = Trap::OUT_OF_BOUNDS;
+      return false;
+    }
+
+    return true;
+  }
+
+  [[nodiscard]]
+  bool constexpr check_key(size_t key) noexcept {
+    if (key >= keyboard.size()) {
+      trap = Trap::OUT_OF_BOUNDS;
+      return false;
+    }
+
+    return true;
+  }
+
+  [[nodiscard]]
+  bool constexpr push(uint16_t location) noexcept {
+    if (stack_pointer == stack.size()) {
+      trap = Trap::STACK_OVERFLOW;
+      return false;
+    }
+
+    stack[stack_pointer++] = location;
+    return true;
+  }
+
+  [[nodiscard]]
+  std::optional<uint16_t> constexpr pop() noexcept {
+    if (stack_pointer == 0) {
+      trap = Trap::STACK_UNDERFLOW;
+      return std::nullopt;
+    }
+
+    return stack[--stack_pointer];
+  }
+
+  void constexpr poll_key() noexcept {
+    for (auto [n, key] : keyboard | std::views::enumerate) {
+      if (key) {
+        registers[*key_wait] = n;
+        key_wait.reset();
+        return;
+      }
+    }
+  }
+
+  bool operator==(Cpu const &) const = default;
+
 private:
+  [[nodiscard]]
+  uint64_t static constexpr _key(size_t location, uint8_t value) noexcept {
+    return value ? mix(location << 8 | value) : 0;
+  }
+
   size_t static constexpr _MEMORY_SIZE = 0x1000;
   uint16_t static constexpr _PROGRAM_START = 0x200;
 
@@ -62,18 +173,28 @@ private:
 
   size_t static constexpr _KEYBOARD_SIZE = 0x10;
 
+  size_t static constexpr _STACK_SIZE = 0x10;
+
 public:
-  std::array<uint8_t, _MEMORY_SIZE> memory{};
-  uint16_t program_counter = _PROGRAM_START;
-  uint16_t index;
+  size_t static constexpr MEMORY_SIZE = _MEMORY_SIZE;
+  size_t static constexpr PROGRAM_SIZE = _MEMORY_SIZE - _PROGRAM_START;
 
+  uint16_t program_counter = _PROGRAM_START;
+  uint16_t index = 0;
   std::array<uint8_t, _REGISTERS_SIZE> registers{};
-
-  std::vector<uint16_t> stack;
-
   std::array<uint8_t, _TIMERS_SIZE> timers{};
+  uint8_t stack_pointer = 0;
+  Trap trap = Trap::NONE;
+  std::optional<uint8_t> key_wait;
+  uint32_t cycles = 0;
+  std::array<uint16_t, _STACK_SIZE> stack{};
+  uint64_t memory_fingerprint = 0;
 
   std::array<bool, _KEYBOARD_SIZE> keyboard{};
   Screen screen;
+
+  std::array<uint8_t, _MEMORY_SIZE> memory{};
 };
+
+static_assert(std::is_trivially_copyable_v<Cpu>);
 } // namespace chip_8
@@ -0,0 +1,242 @@
+#include "debugger.hpp"
+#include "disassembler.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+using namespace chip_8;
+
+namespace {
+struct Breakpoint final : public Instruction {
+  void operator()(Cpu &cpu) const noexcept override {
+    cpu.step_program_counter(-1);
+    cpu.trap = Trap::BREAKPOINT;
+  }
+};
+
+// FX33 and FX55 write at most 16 bytes starting at I
+struct Watchpoint final : public Instruction {
+  Watchpoint(std::unique_ptr<Instruction> instruction,
+             std::set<uint16_t> const &locations) noexcept
+      : _instruction(std::move(instruction)), _locations(locations) {}
+
+  void operator()(Cpu &cpu) const noexcept override {
+    size_t begin = std::min<size_t>(cpu.index, cpu.memory.size());
+    size_t end = std::min(begin + _WINDOW_SIZE, cpu.memory.size());
+
+    std::array<uint8_t, _WINDOW_SIZE> before{};
+    std::copy(cpu.memory.begin() + begin, cpu.memory.begin() + end,
+              before.begin());
+
+    std::invoke(*_instruction, cpu);
+
+    for (auto it = _locations.lower_bound(begin);
+         it != _locations.end() && *it < end; it++) {
+      if (cpu.memory[*it] != before[*it - begin]) {
+        cpu.trap = Trap::WATCHPOINT;
+        return;
+      }
+    }
+  }
+
+private:
+  size_t static constexpr _WINDOW_SIZE = 0x10;
+
+  std::unique_ptr<Instruction> _instruction;
+  std::set<uint16_t> const &_locations;
+};
+
+bool writes_memory(Opcode const &opcode) noexcept {
+  return opcode.a() == 0xF && (opcode.nn() == 0x33 || opcode.nn() == 0x55);
+}
+} // namespace
+
+Debugger::Debugger(Emulator &emulator) : _emulator(emulator) {}
+
+Debugger::~Debugger() {
+  if (_attached) {
+    _emulator.set_patch(nullptr);
+  }
+}
+
+void Debugger::add_breakpoint(uint16_t location) {
+  _breakpoints.insert(location);
+  _attach();
+  _emulator.invalidate(location);
+}
+
+void Debugger::remove_breakpoint(uint16_t location) {
+  _breakpoints.erase(location);
+  _attach();
+  _emulator.invalidate(location);
+}
+
+void Debugger::add_watchpoint(uint16_t location) {
+  if (_watchpoints.empty()) {
+    _emulator.invalidate();
+  }
+  _watchpoints.insert(location);
+  _attach();
+}
+
+void Debugger::remove_watchpoint(uint16_t location) {
+  _watchpoints.erase(location);
+  if (_watchpoints.empty()) {
+    _emulator.invalidate();
+  }
+  _attach();
+}
+
+void Debugger::reset() {
+  _clear_stop();
+  _breakpoints.clear();
+  _watchpoints.clear();
+  _paused = false;
+  _attach();
+}
+
+bool Debugger::stopped() const noexcept { return _emulator.suspended(); }
+
+void Debugger::resume() {
+  _clear_stop();
+  if (_breakpoints.contains(_emulator.cpu.program_counter)) {
+    step();
+  }
+  _paused = false;
+}
+
+bool Debugger::step() {
+  _clear_stop();
+  _paused = true;
+
+  auto location = _emulator.cpu.program_counter;
+  _skip = location;
+  _emulator.invalidate(location);
+
+  auto result = _emulator.step();
+
+  _skip.reset();
+  _emulator.invalidate(location);
+  return result;
+}
+
+bool Debugger::step_over(size_t limit) {
+  auto &&cpu = _emulator.cpu;
+  auto word = cpu.fetch<uint16_t>(cpu.program_counter);
+  if (cpu.key_wait || !word || Opcode{*word}.a() != 0x2) {
+    return step();
+  }
+
+  auto location = cpu.program_counter + 2;
+  auto depth = cpu.stack_pointer;
+  if (!step()) {
+    return false;
+  }
+
+  for (size_t i = 1; i < limit; i++) {
+    if (cpu.program_counter == location && cpu.stack_pointer == depth) {
+      return true;
+    }
+    if (!_emulator.step()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void Debugger::write_location(std::ostream &ostream) const {
+  auto &&cpu = _emulator.cpu;
+  ostream << "0x" << hex(cpu.program_counter, 3);
+
+  auto word = cpu.fetch<uint16_t>(cpu.program_counter);
+  if (!word) {
+    ostream << "  ????\n";
+    return;
+  }
+
+  ostream << "  " << hex(*word, 4);
+  ostream << "  " << disassemble(Opcode{*word}).value_or("???");
+
+  if (cpu.trap == Trap::BREAKPOINT) {
+    ostream << "  [breakpoint]";
+  } else if (cpu.trap == Trap::WATCHPOINT) {
+    ostream << "  [watchpoint]";
+  }
+  ostream << '\n';
+}
+
+void Debugger::write_registers(std::ostream &ostream) const {
+  auto &&cpu = _emulator.cpu;
+
+  ostream << "PC=0x" << hex(cpu.program_counter, 3) << " I=0x"
+          << hex(cpu.index, 3);
+  ostream << " SP=" << +cpu.stack_pointer;
+  ostream << " DT=" << +cpu.timers[std::to_underlying(Timer::DELAY)];
+  ostream << " ST=" << +cpu.timers[std::to_underlying(Timer::SOUND)] << '\n';
+
+  for (auto [n, value] : cpu.registers | std::views::enumerate) {
+    ostream << (n ? " V" : "V") << hex(n, 1) << '=' << hex(value, 2);
+  }
+  ostream << '\n';
+
+  for (uint8_t n = 0; n < cpu.stack_pointer; n++) {
+    ostream << (n ? " " : "stack: 0x") << hex(cpu.stack[n], 3);
+  }
+  if (cpu.stack_pointer) {
+    ostream << '\n';
+  }
+}
+
+void Debugger::write_memory(std::ostream &ostream, uint16_t location,
+                            size_t size) const {
+  auto &&memory = _emulator.cpu.memory;
+  size_t end = std::min(location + size, memory.size());
+
+  for (size_t row = location; row < end; row += 0x10) {
+    ostream << "0x" << hex(row, 3) << ':';
+    for (size_t i = row; i < std::min(row + 0x10, end); i++) {
+      ostream << ' ' << hex(memory[i], 2);
+    }
+    ostream << '\n';
+  }
+}
+
+std::unique_ptr<Instruction>
+Debugger::_patch(uint16_t location, Opcode const &opcode,
+                 std::unique_ptr<Instruction> instruction) {
+  if (location != _skip && _breakpoints.contains(location)) {
+    return std::make_unique<Breakpoint>();
+  }
+
+  if (!_watchpoints.empty() && writes_memory(opcode)) {
+    return std::make_unique<Watchpoint>(std::move(instruction), _watchpoints);
+  }
+
+  return instruction;
+}
+
+void Debugger::_attach() {
+  bool attach = !_breakpoints.empty() || !_watchpoints.empty();
+  if (attach == _attached) {
+    return;
+  }
+
+  _attached = attach;
+  if (!attach) {
+    _emulator.set_patch(nullptr);
+    return;
+  }
+
+  _emulator.set_patch([this](auto location, auto &&opcode, auto instruction) {
+    return _patch(location, opcode, std::move(instruction));
+  });
+}
+
+void Debugger::_clear_stop() noexcept {
+  if (stopped()) {
+    _emulator.cpu.trap = Trap::NONE;
+  }
+}
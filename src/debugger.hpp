@@ -0,0 +1,79 @@
+#pragma once
+
+#include "emulator.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <set>
+
+namespace chip_8 {
+
+class Debugger {
+public:
+  explicit Debugger(Emulator &emulator);
+  Debugger(Debugger const &) = delete;
+  Debugger &operator=(Debugger const &) = delete;
+  ~Debugger();
+
+  void add_breakpoint(uint16_t location);
+
+  void remove_breakpoint(uint16_t location);
+
+  void add_watchpoint(uint16_t location);
+
+  void remove_watchpoint(uint16_t location);
+
+  void reset();
+
+  [[nodiscard]]
+  std::set<uint16_t> const &breakpoints() const noexcept {
+    return _breakpoints;
+  }
+
+  [[nodiscard]]
+  std::set<uint16_t> const &watchpoints() const noexcept {
+    return _watchpoints;
+  }
+
+  [[nodiscard]]
+  bool stopped() const noexcept;
+
+  [[nodiscard]]
+  bool running() const noexcept {
+    return !_paused && !stopped();
+  }
+
+  void pause() noexcept { _paused = true; }
+
+  void resume();
+
+  bool step();
+
+  bool step_over(size_t limit = STEP_OVER_LIMIT);
+
+  void write_location(std::ostream &ostream) const;
+
+  void write_registers(std::ostream &ostream) const;
+
+  void write_memory(std::ostream &ostream, uint16_t location,
+                    size_t size) const;
+
+  size_t static constexpr STEP_OVER_LIMIT = 1'000'000;
+
+private:
+  std::unique_ptr<Instruction> _patch(uint16_t location, Opcode const &opcode,
+                                      std::unique_ptr<Instruction> instruction);
+
+  void _attach();
+
+  void _clear_stop() noexcept;
+
+  Emulator &_emulator;
+  std::set<uint16_t> _breakpoints;
+  std::set<uint16_t> _watchpoints;
+  std::optional<uint16_t> _skip;
+  bool _attached = false;
+  bool _paused = false;
+};
+} // namespace chip_8
@@ -0,0 +1,123 @@
+#include "disassembler.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+
+#include <typeindex>
+#include <unordered_map>
+
+using namespace chip_8;
+
+namespace {
+std::string address(Opcode const &opcode) {
+  return "0x" + hex(opcode.nnn(), 3);
+}
+
+std::string byte(Opcode const &opcode) { return "0x" + hex(opcode.nn(), 2); }
+
+std::string reg(uint8_t reg) { return "V" + hex(reg, 1); }
+
+std::string x(Opcode const &opcode) { return reg(opcode.x()); }
+
+std::string xy(Opcode const &opcode) {
+  return reg(opcode.x()) + ", " + reg(opcode.y());
+}
+
+using Format = std::string (*)(Opcode const &opcode);
+
+// Keyed by the instruction decode() builds, so which opcodes are legal and
+// what they do is only ever decided by the parser
+std::unordered_map<std::type_index, Format> const FORMATS = {
+    {typeid(CallMCRoutine),
+     [](Opcode const &opcode) { return "SYS " + address(opcode); }},
+    {typeid(ClearScreen), [](Opcode const &) { return std::string{"CLS"}; }},
+    {typeid(ReturnSubroutine),
+     [](Opcode const &) { return std::string{"RET"}; }},
+    {typeid(Jump),
+     [](Opcode const &opcode) { return "JP " + address(opcode); }},
+    {typeid(CallSubroutine),
+     [](Opcode const &opcode) { return "CALL " + address(opcode); }},
+    {typeid(SkipIfEqValue),
+     [](Opcode const &opcode) {
+       return "SE " + x(opcode) + ", " + byte(opcode);
+     }},
+    {typeid(SkipIfNotEqValue),
+     [](Opcode const &opcode) {
+       return "SNE " + x(opcode) + ", " + byte(opcode);
+     }},
+    {typeid(SkipIfEqRegister),
+     [](Opcode const &opcode) { return "SE " + xy(opcode); }},
+    {typeid(SetRegisterToValue),
+     [](Opcode const &opcode) {
+       return "LD " + x(opcode) + ", " + byte(opcode);
+     }},
+    {typeid(AddRegisterValue),
+     [](Opcode const &opcode) {
+       return "ADD " + x(opcode) + ", " + byte(opcode);
+     }},
+    {typeid(SetRegisterToRegister),
+     [](Opcode const &opcode) { return "LD " + xy(opcode); }},
+    {typeid(Or), [](Opcode const &opcode) { return "OR " + xy(opcode); }},
+    {typeid(And), [](Opcode const &opcode) { return "AND " + xy(opcode); }},
+    {typeid(Xor), [](Opcode const &opcode) { return "XOR " + xy(opcode); }},
+    {typeid(AddRegisterRegister),
+     [](Opcode const &opcode) { return "ADD " + xy(opcode); }},
+    {typeid(SubtractRegisterRegister),
+     [](Opcode const &opcode) { return "SUB " + xy(opcode); }},
+    {typeid(ShiftRight),
+     [](Opcode const &opcode) { return "SHR " + xy(opcode); }},
+    {typeid(ReverseSubtractRegisterRegister),
+     [](Opcode const &opcode) { return "SUBN " + xy(opcode); }},
+    {typeid(ShiftLeft),
+     [](Opcode const &opcode) { return "SHL " + xy(opcode); }},
+    {typeid(SkipIfNotEqRegister),
+     [](Opcode const &opcode) { return "SNE " + xy(opcode); }},
+    {typeid(SetIndex),
+     [](Opcode const &opcode) { return "LD I, " + address(opcode); }},
+    {typeid(JumpPlus),
+     [](Opcode const &opcode) { return "JP V0, " + address(opcode); }},
+    {typeid(Random),
+     [](Opcode const &opcode) {
+       return "RND " + x(opcode) + ", " + byte(opcode);
+     }},
+    {typeid(Draw),
+     [](Opcode const &opcode) {
+       return "DRW " + xy(opcode) + ", " + hex(opcode.n(), 1);
+     }},
+    {typeid(SkipIfKeyPressed),
+     [](Opcode const &opcode) { return "SKP " + x(opcode); }},
+    {typeid(SkipIfKeyNotPressed),
+     [](Opcode const &opcode) { return "SKNP " + x(opcode); }},
+    {typeid(GetDelay),
+     [](Opcode const &opcode) { return "LD " + x(opcode) + ", DT"; }},
+    {typeid(GetKeyBlocking),
+     [](Opcode const &opcode) { return "LD " + x(opcode) + ", K"; }},
+    {typeid(SetDelay),
+     [](Opcode const &opcode) { return "LD DT, " + x(opcode); }},
+    {typeid(SetSound),
+     [](Opcode const &opcode) { return "LD ST, " + x(opcode); }},
+    {typeid(AddToAdress),
+     [](Opcode const &opcode) { return "ADD I, " + x(opcode); }},
+    {typeid(SetAdressToSprite),
+     [](Opcode const &opcode) { return "LD F, " + x(opcode); }},
+    {typeid(StoreBCDAtAdress),
+     [](Opcode const &opcode) { return "LD B, " + x(opcode); }},
+    {typeid(DumpRegisters),
+     [](Opcode const &opcode) { return "LD [I], " + x(opcode); }},
+    {typeid(LoadRegisters),
+     [](Opcode const &opcode) { return "LD " + x(opcode) + ", [I]"; }},
+};
+} // namespace
+
+std::optional<std::string> chip_8::disassemble(Opcode const &opcode) {
+  auto instruction = decode(opcode);
+  if (!instruction || !*instruction) {
+    return std::nullopt;
+  }
+
+  auto format = FORMATS.find(typeid(**instruction));
+  if (format == FORMATS.end()) {
+    return std::nullopt;
+  }
+
+  return format->second(opcode);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "opcode.hpp"
+
+#include <optional>
+#include <string>
+
+namespace chip_8 {
+
+[[nodiscard]]
+std::optional<std::string> disassemble(Opcode const &opcode);
+} // namespace chip_8
@@ -1,10 +1,27 @@
 #include "emulator.hpp"
 
 #include <fstream>
+#include <algorithm>
 #include <functional>
+#include <utility>
 
 using namespace chip_8;
 
+namespace {
+// Instructions are immutable, so every emulator shares one decoding of each
+// opcode and stepping never allocates
+auto const INSTRUCTIONS = [] {
+  auto instructions =
+      std::make_unique<std::array<std::unique_ptr<Instruction>, 0x10000>>();
+  for (size_t word = 0; word < instructions->size(); word++) {
+    (*instructions)[word] =
+        decode(Opcode{static_cast<uint16_t>(word)}).value_or(nullptr);
+  }
+
+  return instructions;
+}();
+} // namespace
+
 std::vector<uint8_t> chip_8::read_binary(std::filesystem::path const &path) {
   std::ifstream ifstream{path, std::ios::binary};
   std::istreambuf_iterator<char> it{ifstream}, end;
@@ -12,16 +29,265 @@ std::vector<uint8_t> chip_8::read_binary(std::filesystem::path const &path) {
   return std::vector<uint8_t>(it, end);
 }
 
-Emulator::Emulator() noexcept = default;
+std::optional<std::vector<uint8_t>> chip_8::read_program(
+    std::filesystem::path const &path) {
+  auto program = read_binary(path);
+  if (program.empty() || program.size() > Cpu::PROGRAM_SIZE) {
+    return std::nullopt;
+  }
+
+  return program;
+}
+
+Emulator::Emulator() = default;
 
 bool Emulator::step() {
-  auto instruction = fetch_instruction(cpu.program_counter);
+  if (cpu.trap != Trap::NONE) {
+    return false;
+  }
+
+  if (cpu.key_wait) {
+    _poll_key();
+    _elapse(_timing.fetch);
+    return true;
+  }
+
+  auto location = cpu.program_counter;
+  auto opcode = fetch_opcode(location);
+
+#ifdef CHIP_8_TRACE
+  auto registers = cpu.registers;
+#endif
+
+  auto instruction = opcode ? _decode(location, *opcode) : nullptr;
+  auto cycles = opcode ? _timing.cycles(*opcode) : _timing.fetch;
   cpu.step_program_counter();
 
   if (instruction) {
-    std::invoke(**instruction, cpu);
+    std::invoke(*instruction, cpu);
+    if (cpu.trap == Trap::BREAKPOINT) {
+      return false;
+    }
+
+#ifdef CHIP_8_PROFILER
+    profiler.record(location, *opcode, cpu.trap == Trap::NONE);
+#endif
+
+    _read_keys(*opcode);
+    instructions++;
+    _elapse(cycles);
+
+#ifdef CHIP_8_TRACE
+    trace.record(location, *opcode, registers, cpu);
+    if (cpu.trap != Trap::NONE) {
+      trace.trap();
+    }
+#endif
+
+    return cpu.trap == Trap::NONE;
+  }
+
+  instructions++;
+  illegal_opcodes++;
+  _elapse(cycles);
+
+#ifdef CHIP_8_PROFILER
+  if (opcode) {
+    profiler.record(location, *opcode, false);
+  }
+#endif
+
+#ifdef CHIP_8_TRACE
+  trace.record(location, opcode.value_or(0), registers, cpu);
+  trace.trap();
+#endif
+
+  return false;
+}
+
+bool Emulator::run_frame() {
+  bool should_draw = false;
+  for (auto frame = frames; frame == frames && !suspended();) {
+    auto event = _advance();
+    should_draw |= event != Event::ILLEGAL_OPCODE && event != Event::TRAP;
+  }
+
+  return should_draw;
+}
+
+// Ends once the debugger suspends the emulator, clear the trap and call run()
+// again to resume
+std::generator<Event> Emulator::run() {
+  for (auto frame = frames; !suspended();) {
+    if (auto event = _advance()) {
+      co_yield *event;
+    }
+
+    if (frame != frames) {
+      frame = frames;
+      co_yield Event::FRAME;
+    }
+  }
+}
+
+std::optional<Event> Emulator::_advance() {
+  if (_skip_idle()) {
+    return std::nullopt;
+  }
+
+  auto sound = std::to_underlying(Timer::SOUND);
+  bool was_sounding = cpu.timers[sound];
+  bool was_waiting = cpu.key_wait.has_value();
+  bool draws = !was_waiting && cpu.fetch<uint8_t>(cpu.program_counter)
+                                       .transform([](auto byte) {
+                                         return byte >> 4 == 0xD;
+                                       })
+                                       .value_or(false);
+
+  if (!step()) {
+    return cpu.trap != Trap::NONE ? Event::TRAP : Event::ILLEGAL_OPCODE;
+  }
+  if (draws) {
+    return Event::DRAW;
+  }
+  if (!was_waiting && cpu.key_wait) {
+    return Event::KEY_WAIT;
+  }
+  if (!was_sounding && cpu.timers[sound]) {
+    return Event::SOUND;
+  }
+
+  return std::nullopt;
+}
+
+void Emulator::_elapse(uint32_t cycles) noexcept {
+  cpu.cycles += cycles;
+  while (cpu.cycles >= _timing.cycles_per_frame) {
+    cpu.cycles -= _timing.cycles_per_frame;
+    decrease_timers();
+    frames++;
+  }
+}
+
+void Emulator::_poll_key() noexcept {
+  auto key_wait = *cpu.key_wait;
+  cpu.poll_key();
+  if (!cpu.key_wait) {
+    keys_read |= 1 << cpu.registers[key_wait];
+  }
+}
+
+void Emulator::_read_keys(Opcode const &opcode) noexcept {
+  auto key = cpu.registers[opcode.x()];
+  auto checks =
+      opcode.a() == 0xE && (opcode.nn() == 0x9E || opcode.nn() == 0xA1);
+  auto waited = opcode.a() == 0xF && opcode.nn() == 0x0A && !cpu.key_wait;
+
+  if ((checks || waited) && key < cpu.keyboard.size()) {
+    keys_read |= 1 << key;
+  }
+}
+
+void Emulator::set_timing(Timing const &timing) noexcept {
+  _timing = timing;
+  cpu.cycles %= _timing.cycles_per_frame;
+}
+
+void Emulator::set_patch(Patch patch) {
+  _patch = std::move(patch);
+  _patched = _patch ? std::make_unique<std::array<Patched, Cpu::MEMORY_SIZE>>()
+                    : nullptr;
+}
+
+void Emulator::invalidate(uint16_t location) noexcept {
+  if (_patched) {
+    (*_patched)[location % Cpu::MEMORY_SIZE].filled = false;
+  }
+}
+
+void Emulator::invalidate() noexcept {
+  if (_patched) {
+    for (auto &&patched : *_patched) {
+      patched.filled = false;
+    }
+  }
+}
+
+// Only a patched emulator keeps per-location instructions, so a batch of
+// environments shares the one decoding of every opcode
+Instruction const *Emulator::_decode(uint16_t location, Opcode const &opcode) {
+  auto instruction = (*INSTRUCTIONS)[opcode.value()].get();
+  if (!_patched || !instruction) {
+    return instruction;
+  }
+
+  auto &&patched = (*_patched)[location];
+  if (!patched.filled || patched.opcode != opcode.value()) {
+    patched = {true, opcode.value(),
+               _patch(location, opcode, decode(opcode).value_or(nullptr))};
+  }
+
+  return patched.instruction.get();
+}
+
+bool Emulator::idle() const noexcept {
+  return _stalled() && std::ranges::none_of(cpu.timers, std::identity{});
+}
+
+bool Emulator::_stalled() const noexcept {
+  return (cpu.trap != Trap::NONE && !suspended()) ||
+         (cpu.key_wait &&
+          std::ranges::none_of(cpu.keyboard, std::identity{}));
+}
+
+bool Emulator::_skip_idle() noexcept {
+  auto remaining = _timing.cycles_per_frame - cpu.cycles;
+  if (_stalled()) {
+    // Each key poll costs a fetch, so the wait overshoots the frame the same
+    // way stepping it out would
+    auto fetch = std::max<uint32_t>(_timing.fetch, 1);
+    auto polls = (remaining + fetch - 1) / fetch;
+    _elapse(cpu.trap == Trap::NONE ? polls * fetch : remaining);
     return true;
   }
 
+#if defined(CHIP_8_PROFILER) || defined(CHIP_8_TRACE)
   return false;
+#else
+  if (_patch) {
+    return false;
+  }
+
+  // FX07, 3X00, 1NNN back to FX07 spins until the delay timer reaches zero
+  auto location = cpu.program_counter;
+  auto opcode = fetch_opcode(location);
+  if (!opcode || opcode->a() != 0xF || opcode->nn() != 0x07) {
+    return false;
+  }
+
+  auto x = opcode->x();
+  auto delay = cpu.timers[std::to_underlying(Timer::DELAY)];
+  if (delay == 0) {
+    return false;
+  }
+
+  auto skip = fetch_opcode(location + 2);
+  auto jump = fetch_opcode(location + 4);
+  if (!skip || skip->value() != (0x3000 | x << 8) || !jump ||
+      jump->value() != (0x1000 | location)) {
+    return false;
+  }
+
+  auto loop = _timing.cycles(*opcode) + _timing.cycles(*skip) +
+              _timing.cycles(*jump);
+  auto iterations = remaining / loop;
+  if (iterations == 0) {
+    return false;
+  }
+
+  cpu.registers[x] = delay;
+  instructions += 3 * iterations;
+  _elapse(iterations * loop);
+  return true;
+#endif
 }
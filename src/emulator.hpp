@@ -3,8 +3,21 @@
 #include "cpu.hpp"
 #include "opcode.hpp"
 #include "parser.hpp"
+#include "timing.hpp"
 
+#ifdef CHIP_8_PROFILER
+#include "profiler.hpp"
+#endif
+
+#ifdef CHIP_8_TRACE
+#include "trace.hpp"
+#endif
+
+#include <array>
 #include <filesystem>
+#include <functional>
+#include <generator>
+#include <memory>
 #include <ranges>
 #include <vector>
 
@@ -13,21 +26,86 @@ namespace chip_8 {
 [[nodiscard]]
 std::vector<uint8_t> read_binary(std::filesystem::path const &path);
 
+[[nodiscard]]
+std::optional<std::vector<uint8_t>> read_program(
+    std::filesystem::path const &path);
+
+enum class Event { FRAME, DRAW, SOUND, KEY_WAIT, ILLEGAL_OPCODE, TRAP };
+
 class Emulator {
 public:
-  Emulator() noexcept;
+  using Patch = std::function<std::unique_ptr<Instruction>(
+      uint16_t location, Opcode const &opcode,
+      std::unique_ptr<Instruction> instruction)>;
+
+  Emulator();
 
   constexpr Emulator(std::ranges::input_range auto &&program) : cpu(program) {}
 
   void constexpr load_program(std::ranges::input_range auto &&program) {
     cpu = Cpu{program};
+#ifdef CHIP_8_PROFILER
+    profiler = Profiler{};
+#endif
   }
 
   bool step();
 
+  bool run_frame();
+
+  [[nodiscard]]
+  std::generator<Event> run();
+
   void decrease_timers() noexcept { return cpu.decrease_timers(); }
 
+  [[nodiscard]]
+  Timing const &timing() const noexcept {
+    return _timing;
+  }
+
+  void set_timing(Timing const &timing) noexcept;
+
+  [[nodiscard]]
+  bool idle() const noexcept;
+
+  [[nodiscard]]
+  bool suspended() const noexcept {
+    return cpu.trap == Trap::BREAKPOINT || cpu.trap == Trap::WATCHPOINT;
+  }
+
+  void set_patch(Patch patch);
+
+  void invalidate(uint16_t location) noexcept;
+
+  void invalidate() noexcept;
+
+  size_t static constexpr INSTRUCTIONS_PER_FRAME =
+      Timing::INSTRUCTIONS_PER_FRAME;
+
 private:
+  struct Patched {
+    bool filled = false;
+    uint16_t opcode = 0;
+    std::unique_ptr<Instruction> instruction;
+  };
+
+  std::optional<Event> _advance();
+
+  void _elapse(uint32_t cycles) noexcept;
+
+  void _poll_key() noexcept;
+
+  void _read_keys(Opcode const &opcode) noexcept;
+
+  [[nodiscard]]
+  Instruction const *_decode(uint16_t location, Opcode const &opcode);
+
+  [[nodiscard]]
+  bool _stalled() const noexcept;
+
+  [[nodiscard]]
+  bool _skip_idle() noexcept;
+
   [[nodiscard]]
   std::optional<Opcode> constexpr fetch_opcode(
       uint16_t location) const noexcept {
@@ -35,14 +113,23 @@ private:
     return word.transform([](auto &&word) { return Opcode{word}; });
   }
 
-  [[nodiscard]]
-  std::optional<std::unique_ptr<Instruction>> constexpr fetch_instruction(
-      uint16_t location) const noexcept {
-    auto opcode = fetch_opcode(location);
-    return opcode.and_then(decode);
-  }
+  Patch _patch;
+  std::unique_ptr<std::array<Patched, Cpu::MEMORY_SIZE>> _patched;
+  Timing _timing = Timing::fixed();
 
 public:
   Cpu cpu;
+  uint64_t instructions = 0;
+  uint64_t illegal_opcodes = 0;
+  uint64_t frames = 0;
+  uint16_t keys_read = 0;
+
+#ifdef CHIP_8_PROFILER
+  Profiler profiler;
+#endif
+
+#ifdef CHIP_8_TRACE
+  Trace trace;
+#endif
 };
 } // namespace chip_8
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "cpu.hpp"
+#include "screen.hpp"
+
+#include <cstdint>
+#include <ranges>
+#include <utility>
+
+namespace chip_8 {
+
+class Fnv1a {
+public:
+  void constexpr update(uint8_t byte) noexcept {
+    _value = (_value ^ byte) * _PRIME;
+  }
+
+  void constexpr update(std::ranges::input_range auto &&range) noexcept {
+    for (auto &&value : range) {
+      for (size_t i = 0; i < sizeof(value); i++) {
+        update(uint8_t(value >> (8 * i)));
+      }
+    }
+  }
+
+  [[nodiscard]]
+  uint64_t constexpr value() const noexcept {
+    return _value;
+  }
+
+private:
+  uint64_t static constexpr _OFFSET_BASIS = 0xCBF29CE484222325;
+  uint64_t static constexpr _PRIME = 0x100000001B3;
+
+  uint64_t _value = _OFFSET_BASIS;
+};
+
+[[nodiscard]]
+uint64_t constexpr hash(Screen const &screen) noexcept {
+  Fnv1a fnv1a;
+  fnv1a.update(screen.rows());
+
+  return fnv1a.value();
+}
+
+[[nodiscard]]
+uint64_t constexpr hash(Cpu const &cpu) noexcept {
+  Fnv1a fnv1a;
+  fnv1a.update(cpu.memory);
+  fnv1a.update(std::views::single(cpu.program_counter));
+  fnv1a.update(std::views::single(cpu.index));
+  fnv1a.update(cpu.registers);
+  fnv1a.update(cpu.stack | std::views::take(cpu.stack_pointer));
+  fnv1a.update(cpu.timers);
+  fnv1a.update(std::views::single(cpu.key_wait.value_or(0xFF)));
+  fnv1a.update(std::views::single(std::to_underlying(cpu.trap)));
+
+  return fnv1a.value();
+}
+} // namespace chip_8
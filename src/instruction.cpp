@@ -1,5 +1,4 @@
 #include "instruction.hpp"
-#include <cassert>
 #include <utility>
 
 using namespace chip_8;
@@ -15,12 +14,9 @@ void ClearScreen::operator()(Cpu &cpu) const noexcept {
 }
 
 void ReturnSubroutine::operator()(Cpu &cpu) const noexcept {
-  assert(cpu.stack.size() > 0);
-
-  auto location = cpu.stack.back();
-  cpu.stack.pop_back();
-
-  cpu.program_counter = location;
+  if (auto location = cpu.pop()) {
+    cpu.program_counter = *location;
+  }
 }
 
 Jump::Jump(size_t location) noexcept : _location(location) {}
@@ -32,13 +28,9 @@ CallSubroutine::CallSubroutine(size_t location) noexcept
     : _location(location) {}
 
 void CallSubroutine::operator()(Cpu &cpu) const noexcept {
-  try {
-    cpu.stack.push_back(cpu.program_counter);
-  } catch (const std::exception &) {
-    assert(false);
+  if (cpu.push(cpu.program_counter)) {
+    cpu.program_counter = _location;
   }
-
-  cpu.program_counter = _location;
 }
 
 SkipIfEqValue::SkipIfEqValue(uint8_t reg, uint8_t value) noexcept
@@ -236,7 +228,7 @@ SkipIfKeyPressed::SkipIfKeyPressed(uint8_t reg) noexcept : _register(reg) {}
 void SkipIfKeyPressed::operator()(Cpu &cpu) const noexcept {
   auto value = cpu.registers[_register];
 
-  if (cpu.keyboard[value]) {
+  if (cpu.check_key(value) && cpu.keyboard[value]) {
     cpu.step_program_counter();
   }
 }
@@ -247,7 +239,7 @@ SkipIfKeyNotPressed::SkipIfKeyNotPressed(uint8_t reg) noexcept
 void SkipIfKeyNotPressed::operator()(Cpu &cpu) const noexcept {
   auto value = cpu.registers[_register];
 
-  if (!cpu.keyboard[value]) {
+  if (cpu.check_key(value) && !cpu.keyboard[value]) {
     cpu.step_program_counter();
   }
 }
@@ -264,16 +256,8 @@ void GetDelay::operator()(Cpu &cpu) const noexcept {
 GetKeyBlocking::GetKeyBlocking(uint8_t reg) noexcept : _register(reg) {}
 
 void GetKeyBlocking::operator()(Cpu &cpu) const noexcept {
-  auto value = cpu.registers[_register];
-
-  for (auto [n, key] : cpu.keyboard | std::views::enumerate) {
-    if (key) {
-      cpu.registers[value] = n;
-      return;
-    }
-  }
-
-  cpu.step_program_counter(-1);
+  cpu.key_wait = _register;
+  cpu.poll_key();
 }
 
 SetDelay::SetDelay(uint8_t reg) noexcept : _register(reg) {}
@@ -309,21 +293,27 @@ void SetAdressToSprite::operator()(Cpu &) const noexcept {}
 StoreBCDAtAdress::StoreBCDAtAdress(uint8_t reg) noexcept : _register(reg) {}
 
 void StoreBCDAtAdress::operator()(Cpu &cpu) const noexcept {
+  if (!cpu.check_memory(cpu.index, _DIGITS_SIZE)) {
+    return;
+  }
+
   auto value = cpu.registers[_register];
   auto bcda = _bcda(value);
 
-  std::ranges::copy_n(bcda.rbegin(), _DIGITS_SIZE,
-                      cpu.memory.begin() + cpu.index);
+  for (size_t i = 0; i < _DIGITS_SIZE; i++) {
+    cpu.write(cpu.index + i, bcda.rbegin()[i]);
+  }
 }
 
 DumpRegisters::DumpRegisters(uint8_t reg) noexcept : _register(reg) {}
 
 void DumpRegisters::operator()(Cpu &cpu) const noexcept {
-  auto location = cpu.memory.begin() + cpu.index;
+  if (!cpu.check_memory(cpu.index, _register + 1)) {
+    return;
+  }
 
-  try {
-    std::ranges::copy_n(cpu.registers.begin(), _register + 1, location);
-  } catch (const std::exception &) {
+  for (size_t i = 0; i <= _register; i++) {
+    cpu.write(cpu.index + i, cpu.registers[i]);
   }
 
   cpu.index += _register + 1;
@@ -332,12 +322,12 @@ void DumpRegisters::operator()(Cpu &cpu) const noexcept {
 LoadRegisters::LoadRegisters(uint8_t reg) noexcept : _register(reg) {}
 
 void LoadRegisters::operator()(Cpu &cpu) const noexcept {
-  auto location = cpu.memory.begin() + cpu.index;
-
-  try {
-    std::ranges::copy_n(location, _register + 1, cpu.registers.begin());
-  } catch (const std::exception &) {
+  if (!cpu.check_memory(cpu.index, _register + 1)) {
+    return;
   }
 
+  auto location = cpu.memory.begin() + cpu.index;
+  std::ranges::copy_n(location, _register + 1, cpu.registers.begin());
+
   cpu.index += _register + 1;
 }
@@ -0,0 +1,78 @@
+#include "latency.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <string_view>
+
+using namespace chip_8;
+
+void LatencyTracker::press(uint8_t key, Clock::time_point now) {
+  std::erase_if(_pending, [&](auto &&event) {
+    return event.key == key && !event.observed;
+  });
+
+  if (_pending.size() == MAX_PENDING) {
+    _pending.pop_front();
+  }
+  _pending.push_back({key, now, std::nullopt, std::nullopt, {}});
+}
+
+void LatencyTracker::frame(uint16_t keys_read, Screen const &presented,
+                           Clock::time_point now) {
+  auto rows = presented.rows();
+
+  for (auto &&event : _pending) {
+    if (!event.observed) {
+      if (!(keys_read >> event.key & 1)) {
+        continue;
+      }
+      event.observed = now;
+      event.rows = _rows;
+    }
+
+    if (!event.changed && rows != event.rows) {
+      event.changed = now;
+    }
+  }
+
+  _rows = rows;
+}
+
+void LatencyTracker::present(Clock::time_point now) {
+  std::erase_if(_pending, [&](auto &&event) {
+    if (!event.changed) {
+      return false;
+    }
+
+    _samples[TOTAL].push_back(now - event.pressed);
+    _samples[OBSERVED].push_back(*event.observed - event.pressed);
+    _samples[CHANGED].push_back(*event.changed - *event.observed);
+    _samples[PRESENTED].push_back(now - *event.changed);
+    return true;
+  });
+}
+
+void LatencyTracker::write_report(std::ostream &ostream) const {
+  std::array<std::string_view, _STAGES> static constexpr NAMES = {
+      "key to presented", "key to observed", "observed to changed",
+      "changed to presented"};
+  std::array static constexpr PERCENTILES = {50, 90, 99, 100};
+
+  ostream << size() << " key events\n" << std::fixed << std::setprecision(2);
+  for (size_t stage = 0; stage < _STAGES; stage++) {
+    auto samples = _samples[stage];
+    if (samples.empty()) {
+      continue;
+    }
+    std::ranges::sort(samples);
+
+    ostream << NAMES[stage] << ':';
+    for (auto percentile : PERCENTILES) {
+      auto rank = (samples.size() * percentile + 99) / 100;
+      std::chrono::duration<double, std::milli> latency =
+          samples[std::max<size_t>(rank, 1) - 1];
+      ostream << " p" << percentile << ' ' << latency.count() << " ms";
+    }
+    ostream << '\n';
+  }
+}
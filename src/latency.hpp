@@ -0,0 +1,52 @@
+#pragma once
+
+#include "screen.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+namespace chip_8 {
+
+class LatencyTracker {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  void press(uint8_t key, Clock::time_point now = Clock::now());
+
+  void frame(uint16_t keys_read, Screen const &presented,
+             Clock::time_point now = Clock::now());
+
+  void present(Clock::time_point now = Clock::now());
+
+  [[nodiscard]]
+  size_t size() const noexcept {
+    return _samples[0].size();
+  }
+
+  void write_report(std::ostream &ostream) const;
+
+  size_t static constexpr MAX_PENDING = 0x40;
+
+private:
+  enum Stage { TOTAL, OBSERVED, CHANGED, PRESENTED };
+
+  size_t static constexpr _STAGES = 4;
+
+  struct Event {
+    uint8_t key;
+    Clock::time_point pressed;
+    std::optional<Clock::time_point> observed;
+    std::optional<Clock::time_point> changed;
+    std::array<uint64_t, Screen::HEIGHT> rows{};
+  };
+
+  std::deque<Event> _pending;
+  std::array<uint64_t, Screen::HEIGHT> _rows{};
+  std::array<std::vector<Clock::duration>, _STAGES> _samples;
+};
+} // namespace chip_8
@@ -0,0 +1,136 @@
+#include "lockstep.hpp"
+#include "emulator.hpp"
+#include "mix.hpp"
+#include "parser.hpp"
+
+#include <algorithm>
+#include <functional>
+
+using namespace chip_8;
+
+bool Reference::step() {
+  if (cpu.trap != Trap::NONE) {
+    return false;
+  }
+
+  if (cpu.key_wait) {
+    cpu.poll_key();
+    _elapse(_timing.fetch);
+    return true;
+  }
+
+  auto word = cpu.fetch<uint16_t>(cpu.program_counter);
+  auto instruction = word ? decode(Opcode{*word}).value_or(nullptr) : nullptr;
+  auto cycles = word ? _timing.cycles(Opcode{*word}) : _timing.fetch;
+  cpu.step_program_counter();
+
+  if (instruction) {
+    std::invoke(*instruction, cpu);
+  }
+  _elapse(cycles);
+
+  return instruction && cpu.trap == Trap::NONE;
+}
+
+void Reference::_elapse(uint32_t cycles) noexcept {
+  cpu.cycles += cycles;
+  while (cpu.cycles >= _timing.cycles_per_frame) {
+    cpu.cycles -= _timing.cycles_per_frame;
+    cpu.decrease_timers();
+  }
+}
+
+uint16_t chip_8::lockstep_keys(LockstepOptions const &options,
+                               uint64_t step) noexcept {
+  auto value =
+      mix(options.seed + (step / options.hold + 1) * 0x9E3779B97F4A7C15);
+
+  return value & 1 ? 1 << (value >> 1 & 0xF) : 0;
+}
+
+namespace {
+class Pair {
+public:
+  Pair(Cpu const &root, LockstepOptions const &options)
+      : _options(options), reference(root, options.timing) {
+    candidate.set_timing(options.timing);
+    if (options.patch) {
+      candidate.set_patch(options.patch);
+    }
+    candidate.cpu = root;
+  }
+
+  void advance(uint64_t to) {
+    for (; steps < to; steps++) {
+      auto keys = lockstep_keys(_options, steps);
+      for (size_t key = 0; key < reference.cpu.keyboard.size(); key++) {
+        reference.cpu.keyboard[key] = candidate.cpu.keyboard[key] =
+            keys >> key & 1;
+      }
+
+      reference.step();
+      candidate.step();
+    }
+  }
+
+  [[nodiscard]]
+  bool matches() const noexcept {
+    return reference.cpu == candidate.cpu;
+  }
+
+  [[nodiscard]]
+  bool halted() const noexcept {
+    return reference.cpu.trap != Trap::NONE &&
+           candidate.cpu.trap != Trap::NONE;
+  }
+
+private:
+  LockstepOptions const &_options;
+
+public:
+  Reference reference;
+  Emulator candidate;
+  uint64_t steps = 0;
+};
+
+// Replays from the root for every probe, so the candidate's state outside Cpu
+// sees the same history it did in the original run
+Divergence bisect(Cpu const &root, LockstepOptions const &options,
+                  uint64_t good, uint64_t bad) {
+  while (bad - good > 1) {
+    auto middle = good + (bad - good) / 2;
+    Pair pair{root, options};
+    pair.advance(middle);
+    (pair.matches() ? good : bad) = middle;
+  }
+
+  Pair pair{root, options};
+  pair.advance(good);
+  Divergence divergence{good, pair.reference.cpu, {}, {}};
+  pair.advance(bad);
+  divergence.reference = pair.reference.cpu;
+  divergence.candidate = pair.candidate.cpu;
+
+  return divergence;
+}
+} // namespace
+
+LockstepResult chip_8::lockstep(Cpu const &root,
+                                LockstepOptions const &options) {
+  Pair pair{root, options};
+  uint64_t checked = 0;
+
+  while (pair.steps < options.steps) {
+    pair.advance(std::min(options.steps, pair.steps + options.interval));
+    if (!pair.matches()) {
+      return {pair.steps, bisect(root, options, checked, pair.steps)};
+    }
+
+    checked = pair.steps;
+    if (pair.halted()) {
+      break;
+    }
+  }
+
+  return {pair.steps, std::nullopt};
+}
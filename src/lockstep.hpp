@@ -0,0 +1,54 @@
+#pragma once
+
+#include "cpu.hpp"
+#include "emulator.hpp"
+#include "timing.hpp"
+
+#include <cstdint>
+#include <optional>
+
+namespace chip_8 {
+
+class Reference {
+public:
+  Reference(Cpu const &cpu, Timing const &timing) noexcept
+      : cpu(cpu), _timing(timing) {}
+
+  bool step();
+
+  Cpu cpu;
+
+private:
+  void _elapse(uint32_t cycles) noexcept;
+
+  Timing _timing;
+};
+
+struct LockstepOptions {
+  uint64_t steps = 10'000'000;
+  uint64_t interval = 1000;
+  uint64_t hold = 600;
+  uint64_t seed = 1;
+  Timing timing = Timing::fixed();
+  // Installed on the candidate, to check a patched engine or inject a fault
+  Emulator::Patch patch;
+};
+
+struct Divergence {
+  uint64_t step = 0;
+  Cpu before;
+  Cpu reference;
+  Cpu candidate;
+};
+
+struct LockstepResult {
+  uint64_t steps = 0;
+  std::optional<Divergence> divergence;
+};
+
+[[nodiscard]]
+uint16_t lockstep_keys(LockstepOptions const &options, uint64_t step) noexcept;
+
+[[nodiscard]]
+LockstepResult lockstep(Cpu const &root, LockstepOptions const &options);
+} // namespace chip_8
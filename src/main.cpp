@@ -1,6 +1,31 @@
+#include "capture.hpp"
+#include "debugger.hpp"
 #include "emulator.hpp"
+#include "latency.hpp"
+#include "metrics.hpp"
+#include "run_ahead.hpp"
+#include "speed_meter.hpp"
+#include "upscaler.hpp"
+#include "wall.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef CHIP_8_PROFILER
+#include <fstream>
+#endif
 
 #include <adwaita.h>
 #include <gtkmm.h>
@@ -10,162 +35,736 @@ using namespace chip_8;
 std::string_view constexpr APP_ID = "org.nesfvillar.chip_8";
 std::string_view constexpr UI_PATH = "../src/builder.ui";
 std::string_view constexpr PROGRAM_PATH = "../br8kout.ch8";
-size_t constexpr INSTRUCTIONS_PER_FRAME = 10;
+std::string_view constexpr TURBO_MULTIPLIER = "4";
+std::string_view constexpr RUN_AHEAD_FRAMES = "0";
+std::string_view constexpr TIMING = "fixed";
+std::string_view constexpr FILTER = "nearest";
+uint8_t constexpr PHOSPHOR_PERSISTENCE = 0xC0;
+std::string_view constexpr CAPTURE_PREFIX = "chip_8-";
+auto constexpr DEFAULT_TICK_INTERVAL = std::chrono::microseconds{16'667};
+int64_t constexpr FRAME_RATE = 60;
+size_t constexpr MAX_CATCH_UP_FRAMES = 4;
+auto constexpr HUD_INTERVAL = std::chrono::seconds{1};
+auto constexpr UNCAPPED_BUDGET = std::chrono::milliseconds{12};
+size_t constexpr UNCAPPED_BATCH = 64;
+
+#ifdef CHIP_8_PROFILER
+std::string_view constexpr PROFILE_JSON_PATH = "chip_8.profile.json";
+std::string_view constexpr PROFILE_FOLDED_PATH = "chip_8.profile.folded";
+#endif
+
+#ifdef CHIP_8_TRACE
+std::string_view constexpr TRACE_PATH = "chip_8.trace";
+#endif
+
+struct LoadRequest {
+  uint64_t generation;
+  std::filesystem::path path;
+  std::string name;
+};
+
+struct LoadResult {
+  uint64_t generation;
+  std::string name;
+  std::optional<std::vector<uint8_t>> program;
+};
+
+struct Session {
+  Emulator emulator;
+  Debugger debugger{emulator};
+  Gtk::Window *window = nullptr;
+  Gtk::Widget *widget = nullptr;
+  Gtk::Widget *title = nullptr;
+  bool ticking = false;
+
+  std::unique_ptr<Wall> wall;
+  std::vector<std::string> wall_names;
+  size_t focused = 0;
+  Cairo::RefPtr<Cairo::ImageSurface> wall_surface;
+
+  Glib::Dispatcher loaded;
+  std::mutex load_mutex;
+  std::condition_variable_any load_requested;
+  std::optional<LoadRequest> load_request;
+  std::optional<LoadResult> load_result;
+  uint64_t load_generation = 0;
+  std::optional<std::vector<uint8_t>> pending_program;
+  std::jthread loader;
+
+  bool turbo = false;
+  size_t turbo_multiplier = 0;
+  Glib::RefPtr<Gio::SimpleAction> turbo_speed_action;
+  SpeedMeter speed_meter;
 
-bool on_key_pressed(guint keyval, guint, Gdk::ModifierType, Cpu *cpu) {
-  auto &&keyboard = cpu->keyboard;
+  size_t run_ahead_frames = 0;
+  Glib::RefPtr<Gio::SimpleAction> run_ahead_action;
+  RunAhead run_ahead;
+  Screen presented;
+
+  Glib::RefPtr<Gio::SimpleAction> timing_action;
+
+  Upscaler upscaler;
+  Cairo::RefPtr<Cairo::ImageSurface> surface;
+  Glib::RefPtr<Gio::SimpleAction> filter_action;
+  Glib::RefPtr<Gio::SimpleAction> phosphor_action;
+
+  std::unique_ptr<Capture> capture;
+  Glib::RefPtr<Gio::SimpleAction> record_action;
+
+  LatencyTracker latency;
+
+  Metrics metrics;
+  EmulatorMetrics emulator_metrics{metrics};
+  Counter &late_ticks = metrics.counter(
+      "chip_8_late_ticks_total", "Display ticks over 1.5 intervals apart.");
+  Counter &dropped_ticks = metrics.counter(
+      "chip_8_dropped_ticks_total", "Display ticks skipped between ticks.");
+  Histogram &tick_interval = metrics.histogram(
+      "chip_8_tick_interval_seconds", "Time between display ticks.");
+  Histogram &draw_time =
+      metrics.histogram("chip_8_draw_seconds", "Host time spent in on_draw.");
+  std::optional<gint64> last_tick;
+  std::optional<gint64> last_paced;
+  int64_t pacing = 0;
+
+  bool hud = false;
+  Glib::RefPtr<Gio::SimpleAction> hud_action;
+  std::vector<std::string> hud_lines;
+  SpeedMeter::Clock::time_point hud_sampled;
+  uint64_t hud_instructions = 0;
+  uint64_t hud_frames = 0;
+};
+
+void set_subtitle(Session *session, std::string const &subtitle) {
+  adw_window_title_set_subtitle(ADW_WINDOW_TITLE(session->title->gobj()),
+                                subtitle.c_str());
+}
 
+bool on_tick(Glib::RefPtr<Gdk::FrameClock> const &, Session *session);
+
+void start_ticking(Session *session) {
+  if (!session->ticking) {
+    session->widget->add_tick_callback(sigc::bind(&on_tick, session));
+    session->ticking = true;
+    session->last_tick.reset();
+    session->last_paced.reset();
+  }
+}
+
+std::optional<uint8_t> keypad(guint keyval) {
   switch (gdk_keyval_to_lower(keyval)) {
   case GDK_KEY_1:
-    keyboard[0x1] = true;
-    break;
+    return 0x1;
   case GDK_KEY_2:
-    keyboard[0x2] = true;
-    break;
+    return 0x2;
   case GDK_KEY_3:
-    keyboard[0x3] = true;
-    break;
+    return 0x3;
   case GDK_KEY_4:
-    keyboard[0xC] = true;
-    break;
+    return 0xC;
   case GDK_KEY_q:
-    keyboard[0x4] = true;
-    break;
+    return 0x4;
   case GDK_KEY_w:
-    keyboard[0x5] = true;
-    break;
+    return 0x5;
   case GDK_KEY_e:
-    keyboard[0x6] = true;
-    break;
+    return 0x6;
   case GDK_KEY_r:
-    keyboard[0xD] = true;
-    break;
+    return 0xD;
   case GDK_KEY_a:
-    keyboard[0x7] = true;
-    break;
+    return 0x7;
   case GDK_KEY_s:
-    keyboard[0x8] = true;
-    break;
+    return 0x8;
   case GDK_KEY_d:
-    keyboard[0x9] = true;
-    break;
+    return 0x9;
   case GDK_KEY_f:
-    keyboard[0xE] = true;
-    break;
+    return 0xE;
   case GDK_KEY_z:
-    keyboard[0xA] = true;
-    break;
+    return 0xA;
   case GDK_KEY_x:
-    keyboard[0x0] = true;
-    break;
+    return 0x0;
   case GDK_KEY_c:
-    keyboard[0xB] = true;
-    break;
+    return 0xB;
   case GDK_KEY_v:
-    keyboard[0xF] = true;
-    break;
+    return 0xF;
+  default:
+    return std::nullopt;
   }
+}
 
-  return true;
+void present(Session *session) {
+  auto &&upscaler = session->upscaler;
+  if (!upscaler.update(session->presented)) {
+    return;
+  }
+
+  auto &&surface = session->surface;
+  if (!surface || surface->get_width() != int(upscaler.width())) {
+    surface = Cairo::ImageSurface::create(
+        Cairo::Surface::Format::A8, upscaler.width(), upscaler.height());
+  }
+
+  surface->flush();
+  auto data = surface->get_data();
+  auto pixels = upscaler.pixels();
+  for (size_t y = 0; y < upscaler.height(); y++) {
+    std::ranges::copy(pixels.subspan(y * upscaler.width(), upscaler.width()),
+                      data + y * surface->get_stride());
+  }
+  surface->mark_dirty();
+
+  session->widget->queue_draw();
 }
 
-void on_key_released(guint keyval, guint, Gdk::ModifierType, Cpu *cpu) {
-  auto &&keyboard = cpu->keyboard;
+void show_location(Session *session) {
+  std::ostringstream location;
+  session->debugger.write_location(location);
 
-  switch (gdk_keyval_to_lower(keyval)) {
-  case GDK_KEY_1:
-    keyboard[0x1] = false;
-    break;
-  case GDK_KEY_2:
-    keyboard[0x2] = false;
-    break;
-  case GDK_KEY_3:
-    keyboard[0x3] = false;
-    break;
-  case GDK_KEY_4:
-    keyboard[0xC] = false;
-    break;
-  case GDK_KEY_q:
-    keyboard[0x4] = false;
-    break;
-  case GDK_KEY_w:
-    keyboard[0x5] = false;
-    break;
-  case GDK_KEY_e:
-    keyboard[0x6] = false;
-    break;
-  case GDK_KEY_r:
-    keyboard[0xD] = false;
-    break;
-  case GDK_KEY_a:
-    keyboard[0x7] = false;
-    break;
-  case GDK_KEY_s:
-    keyboard[0x8] = false;
-    break;
-  case GDK_KEY_d:
-    keyboard[0x9] = false;
-    break;
-  case GDK_KEY_f:
-    keyboard[0xE] = false;
-    break;
-  case GDK_KEY_z:
-    keyboard[0xA] = false;
+  auto subtitle = location.str();
+  subtitle.pop_back();
+  set_subtitle(session, "Paused at " + subtitle);
+}
+
+bool on_debug_key(guint keyval, Session *session) {
+  auto &&debugger = session->debugger;
+
+  switch (keyval) {
+  case GDK_KEY_F5:
+    if (debugger.running()) {
+      debugger.pause();
+    } else {
+      debugger.resume();
+      set_subtitle(session, "");
+      start_ticking(session);
+    }
     break;
-  case GDK_KEY_x:
-    keyboard[0x0] = false;
+  case GDK_KEY_F9:
+    if (auto location = session->emulator.cpu.program_counter;
+        debugger.breakpoints().contains(location)) {
+      debugger.remove_breakpoint(location);
+    } else {
+      debugger.add_breakpoint(location);
+    }
     break;
-  case GDK_KEY_c:
-    keyboard[0xB] = false;
+  case GDK_KEY_F10:
+    debugger.step_over();
     break;
-  case GDK_KEY_v:
-    keyboard[0xF] = false;
+  case GDK_KEY_F11:
+    debugger.step();
     break;
+  default:
+    return false;
+  }
+
+  if (!debugger.running()) {
+    show_location(session);
+    session->presented = session->emulator.cpu.screen;
+    present(session);
   }
+
+  return true;
 }
-void on_draw(Cairo::RefPtr<Cairo::Context> const &cr, int width, int height,
-             Gtk::Widget const *widget, Emulator const *emulator) {
-  auto screen = emulator->cpu.screen;
 
-  int pixel_height = height / screen.HEIGHT;
-  int pixel_width = width / screen.WIDTH;
+bool on_key_pressed(guint keyval, guint, Gdk::ModifierType,
+                    Session *session) {
+  if (session->wall) {
+    if (auto key = keypad(keyval)) {
+      session->wall->set_key(session->focused, *key, true);
+    }
+    return true;
+  }
 
-  for (size_t y = 0; y < screen.HEIGHT; y++) {
-    for (size_t x = 0; x < screen.WIDTH; x++) {
+  if (on_debug_key(keyval, session)) {
+    return true;
+  }
 
-      if (screen[x, y]) {
-        cr->rectangle(x * pixel_width, y * pixel_height, pixel_width,
-                      pixel_height);
-      }
+  if (auto key = keypad(keyval)) {
+    if (!session->emulator.cpu.keyboard[*key]) {
+      session->latency.press(*key);
+    }
+    session->emulator.cpu.keyboard[*key] = true;
+    start_ticking(session);
+  }
+
+  return true;
+}
+
+void on_key_released(guint keyval, guint, Gdk::ModifierType,
+                     Session *session) {
+  if (auto key = keypad(keyval)) {
+    if (session->wall) {
+      session->wall->set_key(session->focused, *key, false);
+    } else {
+      session->emulator.cpu.keyboard[*key] = false;
     }
   }
+}
+
+void focus_tile(Session *session, size_t tile) {
+  session->wall->release_keys(session->focused);
+  session->focused = tile;
+  set_subtitle(session, session->wall_names[tile]);
+  session->widget->queue_draw();
+}
+
+void on_wall_pressed(int, double x, double y, Session *session) {
+  if (!session->wall) {
+    return;
+  }
+
+  auto &&wall = *session->wall;
+  auto width = session->widget->get_width();
+  auto height = session->widget->get_height();
+  if (auto tile = wall.tile_at(x * wall.width() / width,
+                               y * wall.height() / height)) {
+    focus_tile(session, *tile);
+  }
+}
+
+void draw_hud(Cairo::RefPtr<Cairo::Context> const &cr,
+              std::vector<std::string> const &lines) {
+  auto constexpr FONT_SIZE = 12.0;
+  auto constexpr MARGIN = 8.0;
+
+  cr->select_font_face("monospace", Cairo::ToyFontFace::Slant::NORMAL,
+                       Cairo::ToyFontFace::Weight::NORMAL);
+  cr->set_font_size(FONT_SIZE);
+
+  for (size_t i = 0; i < lines.size(); i++) {
+    cr->move_to(MARGIN, MARGIN + FONT_SIZE * (i + 1));
+    cr->show_text(lines[i]);
+  }
+}
+
+void draw_wall(Cairo::RefPtr<Cairo::Context> const &cr, int width,
+               int height, Session *session) {
+  auto &&wall = *session->wall;
+  if (!session->wall_surface) {
+    return;
+  }
+
+  cr->save();
+  cr->scale(double(width) / wall.width(), double(height) / wall.height());
+
+  auto pattern = Cairo::SurfacePattern::create(session->wall_surface);
+  pattern->set_filter(Cairo::SurfacePattern::Filter::NEAREST);
+  cr->mask(pattern);
+
+  auto [x, y, tile_width, tile_height] = wall.rect(session->focused);
+  cr->set_line_width(1);
+  cr->rectangle(x - 0.5, y - 0.5, tile_width + 1, tile_height + 1);
+  cr->stroke();
+  cr->restore();
+}
+
+void on_draw(Cairo::RefPtr<Cairo::Context> const &cr, int width, int height,
+             Gtk::Widget const *widget, Session *session) {
+  if (session->wall) {
+    auto color = widget->get_color();
+    cr->set_source_rgba(color.get_red(), color.get_green(), color.get_blue(),
+                        color.get_alpha());
+    draw_wall(cr, width, height, session);
+    return;
+  }
+
+  auto const &surface = session->surface;
+  if (!surface) {
+    return;
+  }
+  auto start = SpeedMeter::Clock::now();
 
   auto color = widget->get_color();
   cr->set_source_rgba(color.get_red(), color.get_green(), color.get_blue(),
                       color.get_alpha());
 
-  cr->fill();
+  cr->save();
+  auto scale = double(session->upscaler.scale());
+  cr->scale(width / Screen::WIDTH / scale, height / Screen::HEIGHT / scale);
+
+  auto pattern = Cairo::SurfacePattern::create(surface);
+  pattern->set_filter(Cairo::SurfacePattern::Filter::NEAREST);
+  cr->mask(pattern);
+  cr->restore();
+
+  if (session->hud) {
+    draw_hud(cr, session->hud_lines);
+  }
+
+  session->latency.present();
+  session->draw_time.observe(SpeedMeter::Clock::now() - start);
+}
+
+bool run_frame(Session *session) {
+  auto &&emulator = session->emulator;
+  auto start = SpeedMeter::Clock::now();
+  auto should_draw = emulator.run_frame();
+  session->emulator_metrics.frame_time.observe(SpeedMeter::Clock::now() -
+                                               start);
+
+  if (session->capture) {
+    session->capture->push(emulator.cpu, emulator.frames);
+  }
+
+  return should_draw;
+}
+
+// Emulated frames due at 60 Hz since the previous tick, independent of the
+// display's refresh rate
+size_t frames_due(Session *session, gint64 frame_time) {
+  auto last_paced = std::exchange(session->last_paced, frame_time);
+  if (!last_paced) {
+    return 1;
+  }
+
+  session->pacing += (frame_time - *last_paced) * FRAME_RATE;
+  auto due = session->pacing / 1'000'000;
+  session->pacing -= due * 1'000'000;
+
+  return std::min<size_t>(std::max<int64_t>(due, 0), MAX_CATCH_UP_FRAMES);
 }
 
-bool on_tick(Glib::RefPtr<Gdk::FrameClock> const &, Gtk::Widget *widget,
-             Emulator *emulator) {
+size_t run_frames(Session *session, size_t due, bool &should_draw) {
+  auto &&emulator = session->emulator;
+  auto &&debugger = session->debugger;
+
+  size_t frames = 0;
+  if (!session->turbo) {
+    for (; frames < due && debugger.running(); frames++) {
+      should_draw |= run_frame(session);
+    }
+    return frames;
+  }
+
+  if (session->turbo_multiplier) {
+    for (; frames < session->turbo_multiplier * due && debugger.running();
+         frames++) {
+      should_draw |= run_frame(session);
+    }
+    return frames;
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + UNCAPPED_BUDGET;
+  do {
+    for (size_t i = 0; i < UNCAPPED_BATCH && debugger.running(); i++) {
+      should_draw |= run_frame(session);
+      frames++;
+    }
+  } while (!emulator.idle() && debugger.running() &&
+           std::chrono::steady_clock::now() < deadline);
+
+  return frames;
+}
+
+// Late and dropped ticks are measured against the display's own refresh
+// interval, falling back to 60 Hz when the backend does not report one
+void record_tick(Session *session,
+                 Glib::RefPtr<Gdk::FrameClock> const &frame_clock) {
+  auto frame_time = frame_clock->get_frame_time();
+  auto last_tick = std::exchange(session->last_tick, frame_time);
+  if (!last_tick) {
+    return;
+  }
+
+  gint64 refresh_interval = 0, presentation_time = 0;
+  frame_clock->get_refresh_info(frame_time, refresh_interval,
+                                presentation_time);
+  auto expected = refresh_interval > 0
+                      ? std::chrono::microseconds{refresh_interval}
+                      : DEFAULT_TICK_INTERVAL;
+
+  std::chrono::microseconds interval{frame_time - *last_tick};
+  session->tick_interval.observe(interval);
+  if (interval > expected * 3 / 2) {
+    session->late_ticks.add();
+    session->dropped_ticks.add(interval / expected - 1);
+  }
+}
+
+void update_hud(Session *session) {
+  auto now = SpeedMeter::Clock::now();
+  std::chrono::duration<double> elapsed = now - session->hud_sampled;
+  if (elapsed < HUD_INTERVAL) {
+    return;
+  }
+  session->hud_sampled = now;
+
+  auto &&metrics = session->emulator_metrics;
+  auto instructions = metrics.instructions.value();
+  auto frames = metrics.frames.value();
+  auto ips = (instructions - std::exchange(session->hud_instructions,
+                                           instructions)) /
+             elapsed.count();
+  auto fps =
+      (frames - std::exchange(session->hud_frames, frames)) / elapsed.count();
+
+  auto milliseconds = [](std::chrono::microseconds value) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(2) << value.count() / 1000.0
+         << " ms";
+    return text.str();
+  };
+
+  std::ostringstream rates;
+  rates << std::fixed << std::setprecision(0) << ips << " IPS  " << fps
+        << " FPS";
+
+  session->hud_lines = {
+      rates.str(),
+      "frame p50 " + milliseconds(metrics.frame_time.quantile(0.5)) +
+          "  p99 " + milliseconds(metrics.frame_time.quantile(0.99)),
+      "tick p99 " + milliseconds(session->tick_interval.quantile(0.99)) +
+          "  late " + std::to_string(session->late_ticks.value()) +
+          "  dropped " + std::to_string(session->dropped_ticks.value()),
+      "draw p99 " + milliseconds(session->draw_time.quantile(0.99)),
+      "illegal opcodes " + std::to_string(metrics.illegal_opcodes.value()),
+  };
+
+  if (session->hud) {
+    session->widget->queue_draw();
+  }
+}
+
+bool on_wall_tick(Glib::RefPtr<Gdk::FrameClock> const &frame_clock,
+                  Session *session) {
+  auto &&wall = *session->wall;
+  // Leave slow workers running rather than blocking the UI thread on them
+  if (!wall.try_finish_frame()) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  auto &&surface = session->wall_surface;
+  if (!surface) {
+    surface = Cairo::ImageSurface::create(Cairo::Surface::Format::A8,
+                                          wall.width(), wall.height());
+  }
+
+  surface->flush();
+  auto stride = size_t(surface->get_stride());
+  auto changed =
+      wall.compose({surface->get_data(), stride * wall.height()}, stride);
+  for (auto tile : changed) {
+    auto [x, y, width, height] = wall.rect(tile);
+    surface->mark_dirty(x, y, width, height);
+  }
+
+  if (auto due = frames_due(session, frame_clock->get_frame_time())) {
+    wall.start_frame(due);
+  }
+
+  if (!changed.empty()) {
+    session->widget->queue_draw();
+  }
+
+  return G_SOURCE_CONTINUE;
+}
+
+bool on_tick(Glib::RefPtr<Gdk::FrameClock> const &frame_clock,
+             Session *session) {
+  if (session->pending_program && session->wall) {
+    session->wall.reset();
+    session->wall_surface.reset();
+  }
+  if (session->wall) {
+    return on_wall_tick(frame_clock, session);
+  }
+
+  if (session->pending_program) {
+    session->debugger.reset();
+    session->emulator.load_program(
+        *std::exchange(session->pending_program, std::nullopt));
+  }
+
+  record_tick(session, frame_clock);
+
+  if (!session->debugger.running()) {
+    show_location(session);
+    session->ticking = false;
+    return G_SOURCE_REMOVE;
+  }
+
   bool should_draw = false;
-  for (size_t i = 0; i < INSTRUCTIONS_PER_FRAME; i++) {
-    should_draw |= emulator->step();
+  auto due = frames_due(session, frame_clock->get_frame_time());
+  session->speed_meter.add(run_frames(session, due, should_draw));
+  session->emulator_metrics.record(session->emulator);
+  update_hud(session);
+
+  if (session->run_ahead_frames) {
+    should_draw |= session->run_ahead.run(session->emulator,
+                                          session->run_ahead_frames);
+    session->presented = session->run_ahead.screen();
+  } else {
+    session->presented = session->emulator.cpu.screen;
+  }
+  session->latency.frame(std::exchange(session->emulator.keys_read, 0),
+                         session->presented);
+
+  if (should_draw || session->upscaler.fading()) {
+    present(session);
   }
 
-  if (should_draw) {
-    widget->queue_draw();
+  if (auto speed = session->speed_meter.sample(); speed && session->turbo) {
+    std::ostringstream subtitle;
+    subtitle << std::fixed << std::setprecision(1) << *speed << "×";
+    set_subtitle(session, subtitle.str());
   }
 
-  emulator->decrease_timers();
   // if (emulator->state().cpu.timers[Timer::SOUND]) {
   // }
 
+  if (!session->debugger.running()) {
+    show_location(session);
+  }
+
+  if (session->emulator.idle() && !session->upscaler.fading()) {
+    session->ticking = false;
+    return G_SOURCE_REMOVE;
+  }
+
   return G_SOURCE_CONTINUE;
 }
 
-void on_app_activate(Glib::RefPtr<Gtk::Application> app, Emulator *emulator) {
+void on_turbo_toggled(Gtk::ToggleButton *button, Session *session) {
+  session->turbo = button->get_active();
+  session->speed_meter.reset();
+  set_subtitle(session, "");
+
+  start_ticking(session);
+}
+
+void on_turbo_speed(Glib::ustring const &value, Session *session) {
+  session->turbo_speed_action->change_state(value);
+  session->turbo_multiplier = std::stoul(value.raw());
+  session->speed_meter.reset();
+}
+
+void on_run_ahead(Glib::ustring const &value, Session *session) {
+  session->run_ahead_action->change_state(value);
+  session->run_ahead_frames = std::stoul(value.raw());
+}
+
+void on_timing(Glib::ustring const &value, Session *session) {
+  if (auto timing = parse_timing(value.raw())) {
+    session->timing_action->change_state(value);
+    session->emulator.set_timing(*timing);
+  }
+}
+
+void on_filter(Glib::ustring const &value, Session *session) {
+  if (auto filter = parse_filter(value.raw())) {
+    session->filter_action->change_state(value);
+    session->upscaler.set_filter(*filter);
+    present(session);
+  }
+}
+
+void on_phosphor(Session *session) {
+  bool phosphor = false;
+  session->phosphor_action->get_state(phosphor);
+  session->phosphor_action->change_state(!phosphor);
+
+  session->upscaler.set_persistence(!phosphor ? PHOSPHOR_PERSISTENCE : 0);
+  start_ticking(session);
+}
+
+void on_record(Session *session) {
+  if (session->capture) {
+    std::ostringstream subtitle;
+    subtitle << session->capture->dropped() << " frames dropped";
+    session->capture.reset();
+    set_subtitle(session, subtitle.str());
+  } else {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    session->capture = Capture::open(std::string{CAPTURE_PREFIX} +
+                                     std::to_string(seconds.count()));
+    set_subtitle(session, session->capture ? "Recording" : "Cannot record");
+  }
+
+  session->record_action->change_state(bool(session->capture));
+}
+
+void on_loaded(Session *session) {
+  std::optional<LoadResult> result;
+  {
+    std::scoped_lock lock{session->load_mutex};
+    result = std::exchange(session->load_result, std::nullopt);
+  }
+
+  if (!result || result->generation != session->load_generation) {
+    return;
+  }
+  if (!result->program) {
+    set_subtitle(session, "Cannot load " + result->name);
+    return;
+  }
+
+  session->pending_program = std::move(result->program);
+  set_subtitle(session, result->name);
+  start_ticking(session);
+}
+
+// Reads the latest requested ROM on a long-lived thread, so the UI thread
+// never joins one
+void load_programs(std::stop_token stop, Session *session) {
+  while (true) {
+    LoadRequest request;
+    {
+      std::unique_lock lock{session->load_mutex};
+      if (!session->load_requested.wait(
+              lock, stop, [&] { return session->load_request.has_value(); })) {
+        return;
+      }
+      request = *std::exchange(session->load_request, std::nullopt);
+    }
+
+    LoadResult result{request.generation, request.name,
+                      read_program(request.path)};
+    {
+      std::scoped_lock lock{session->load_mutex};
+      session->load_result = std::move(result);
+    }
+    session->loaded.emit();
+  }
+}
+
+void load_async(Session *session, Glib::RefPtr<Gio::File> const &file) {
+  if (!session->loader.joinable()) {
+    session->loader = std::jthread{load_programs, session};
+  }
+
+  {
+    std::scoped_lock lock{session->load_mutex};
+    session->load_request = LoadRequest{++session->load_generation,
+                                        file->get_path(), file->get_basename()};
+  }
+  session->load_requested.notify_one();
+}
+
+void on_open(Session *session) {
+  auto filter = Gtk::FileFilter::create();
+  filter->set_name("CHIP-8 programs");
+  filter->add_pattern("*.ch8");
+
+  auto filters = Gio::ListStore<Gtk::FileFilter>::create();
+  filters->append(filter);
+
+  auto dialog = Gtk::FileDialog::create();
+  dialog->set_title("Open Program");
+  dialog->set_filters(filters);
+  dialog->open(*session->window,
+               [session, dialog](Glib::RefPtr<Gio::AsyncResult> &result) {
+                 try {
+                   load_async(session, dialog->open_finish(result));
+                 } catch (Gtk::DialogError const &) {
+                 }
+               });
+}
+
+void on_hud(Session *session) {
+  session->hud = !session->hud;
+  session->hud_action->change_state(session->hud);
+  session->widget->queue_draw();
+}
+
+void on_app_activate(Glib::RefPtr<Gtk::Application> app, Session *session) {
 
   auto builder = Gtk::Builder::create_from_file(UI_PATH.data());
 
@@ -174,28 +773,121 @@ void on_app_activate(Glib::RefPtr<Gtk::Application> app, Emulator *emulator) {
 
   auto drawing_area = builder->get_object<Gtk::DrawingArea>("drawing_area");
   drawing_area->set_draw_func(
-      sigc::bind(&on_draw, drawing_area.get(), emulator));
-  drawing_area->add_tick_callback(
-      sigc::bind(&on_tick, drawing_area.get(), emulator));
+      sigc::bind(&on_draw, drawing_area.get(), session));
+
+  session->window = window.get();
+  session->widget = drawing_area.get();
+  session->title = builder->get_object<Gtk::Widget>("title").get();
+  start_ticking(session);
+
+  auto open_button = builder->get_object<Gtk::Button>("open_button");
+  open_button->signal_clicked().connect(sigc::bind(&on_open, session));
+  session->loaded.connect(sigc::bind(&on_loaded, session));
+
+  auto turbo_button = builder->get_object<Gtk::ToggleButton>("turbo_button");
+  turbo_button->signal_toggled().connect(
+      sigc::bind(&on_turbo_toggled, turbo_button.get(), session));
+
+  session->turbo_speed_action = window->add_action_radio_string(
+      "turbo-speed", sigc::bind(&on_turbo_speed, session),
+      TURBO_MULTIPLIER.data());
+  on_turbo_speed(TURBO_MULTIPLIER.data(), session);
+
+  session->run_ahead_action = window->add_action_radio_string(
+      "run-ahead", sigc::bind(&on_run_ahead, session),
+      RUN_AHEAD_FRAMES.data());
+  on_run_ahead(RUN_AHEAD_FRAMES.data(), session);
+
+  session->timing_action = window->add_action_radio_string(
+      "timing", sigc::bind(&on_timing, session), TIMING.data());
+  on_timing(TIMING.data(), session);
+
+  session->filter_action = window->add_action_radio_string(
+      "filter", sigc::bind(&on_filter, session), FILTER.data());
+  on_filter(FILTER.data(), session);
+
+  session->phosphor_action = window->add_action_bool(
+      "phosphor", sigc::bind(&on_phosphor, session), false);
+
+  session->record_action = window->add_action_bool(
+      "record", sigc::bind(&on_record, session), false);
+
+  session->hud_action =
+      window->add_action_bool("hud", sigc::bind(&on_hud, session), false);
+
+  auto click = Gtk::GestureClick::create();
+  click->signal_pressed().connect(sigc::bind(&on_wall_pressed, session));
+  drawing_area->add_controller(click);
+
+  if (session->wall) {
+    focus_tile(session, 0);
+  }
 
   auto key_controller = Gtk::EventControllerKey::create();
   key_controller->signal_key_pressed().connect(
-      sigc::bind(&on_key_pressed, &emulator->cpu), true);
+      sigc::bind(&on_key_pressed, session), true);
   key_controller->signal_key_released().connect(
-      sigc::bind(&on_key_released, &emulator->cpu), false);
+      sigc::bind(&on_key_released, session), false);
   window->add_controller(key_controller);
 
   window->present();
 }
 
+void on_app_open(Gio::Application::type_vec_files const &files,
+                 Glib::ustring const &, Glib::RefPtr<Gtk::Application> app,
+                 Session *session) {
+  std::vector<std::vector<uint8_t>> programs;
+  for (auto &&file : files) {
+    if (auto program = read_program(file->get_path())) {
+      programs.push_back(std::move(*program));
+      session->wall_names.push_back(file->get_basename());
+    } else {
+      std::cerr << file->get_parse_name() << ": not a loadable ROM\n";
+    }
+  }
+
+  if (programs.size() == 1) {
+    session->pending_program = std::move(programs.front());
+  } else if (!programs.empty()) {
+    session->wall = std::make_unique<Wall>(programs);
+  }
+
+  on_app_activate(app, session);
+}
+
 int main(int argc, char *argv[]) {
   adw_init();
-  auto app = Gtk::Application::create(APP_ID.data());
+  auto app = Gtk::Application::create(APP_ID.data(),
+                                      Gio::Application::Flags::HANDLES_OPEN);
+
+  auto program = read_program(PROGRAM_PATH.data());
+  Session session{Emulator{program.value_or(std::vector<uint8_t>{})}};
+  auto &&emulator = session.emulator;
+
+#ifdef CHIP_8_TRACE
+  emulator.trace.trap_path = TRACE_PATH;
+#endif
+
+  app->signal_activate().connect(sigc::bind(&on_app_activate, app, &session));
+  app->signal_open().connect(sigc::bind(&on_app_open, app, &session));
 
-  auto program = read_binary(PROGRAM_PATH.data());
-  Emulator emulator{std::move(program)};
+  auto status = app->run(argc, argv);
 
-  app->signal_activate().connect(sigc::bind(&on_app_activate, app, &emulator));
+#ifdef CHIP_8_PROFILER
+  std::ofstream json{PROFILE_JSON_PATH.data()};
+  emulator.profiler.write_json(json);
+
+  std::ofstream folded{PROFILE_FOLDED_PATH.data()};
+  emulator.profiler.write_folded(folded);
+#endif
+
+#ifdef CHIP_8_TRACE
+  emulator.trace.dump(emulator.trace.trap_path);
+#endif
+
+  if (session.latency.size()) {
+    session.latency.write_report(std::cerr);
+  }
 
-  return app->run(argc, argv);
+  return status;
 }
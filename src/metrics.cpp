@@ -0,0 +1,193 @@
+#include "metrics.hpp"
+#include "unix_socket.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace chip_8;
+
+void Histogram::observe(Duration duration) noexcept {
+  auto microseconds =
+      std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+  auto value = uint64_t(std::max<int64_t>(microseconds, 0));
+
+  auto bucket = std::min<size_t>(std::bit_width(value), BUCKETS - 1);
+  _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  _sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::count() const noexcept {
+  uint64_t count = 0;
+  for (auto &&bucket : _buckets) {
+    count += bucket.load(std::memory_order_relaxed);
+  }
+
+  return count;
+}
+
+std::chrono::microseconds Histogram::quantile(double quantile) const noexcept {
+  auto buckets = this->buckets();
+  uint64_t count = 0;
+  for (auto bucket : buckets) {
+    count += bucket;
+  }
+
+  auto rank = quantile * count;
+  uint64_t cumulative = 0;
+  for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+    cumulative += buckets[bucket];
+    if (cumulative && cumulative >= rank) {
+      return bound(bucket);
+    }
+  }
+
+  return bound(BUCKETS - 1);
+}
+
+std::array<uint64_t, Histogram::BUCKETS> Histogram::buckets() const noexcept {
+  std::array<uint64_t, BUCKETS> buckets;
+  for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+    buckets[bucket] = _buckets[bucket].load(std::memory_order_relaxed);
+  }
+
+  return buckets;
+}
+
+Counter &Metrics::counter(std::string name, std::string help) {
+  std::scoped_lock lock{_mutex};
+  return _counters.emplace_back(std::move(name), std::move(help)).metric;
+}
+
+Histogram &Metrics::histogram(std::string name, std::string help) {
+  std::scoped_lock lock{_mutex};
+  return _histograms.emplace_back(std::move(name), std::move(help)).metric;
+}
+
+void Metrics::write(std::ostream &ostream) const {
+  std::scoped_lock lock{_mutex};
+
+  for (auto &&[name, help, counter] : _counters) {
+    ostream << "# HELP " << name << ' ' << help << '\n'
+            << "# TYPE " << name << " counter\n"
+            << name << ' ' << counter.value() << '\n';
+  }
+
+  for (auto &&[name, help, histogram] : _histograms) {
+    ostream << "# HELP " << name << ' ' << help << '\n'
+            << "# TYPE " << name << " histogram\n";
+
+    uint64_t cumulative = 0;
+    auto buckets = histogram.buckets();
+    for (size_t bucket = 0; bucket < buckets.size(); bucket++) {
+      cumulative += buckets[bucket];
+      if (bucket + 1 == buckets.size()) {
+        ostream << name << "_bucket{le=\"+Inf\"} " << cumulative << '\n';
+      } else {
+        std::chrono::duration<double> le = Histogram::bound(bucket);
+        ostream << name << "_bucket{le=\"" << le.count() << "\"} "
+                << cumulative << '\n';
+      }
+    }
+
+    std::chrono::duration<double> sum = histogram.sum();
+    ostream << name << "_sum " << sum.count() << '\n'
+            << name << "_count " << cumulative << '\n';
+  }
+}
+
+bool Metrics::write_textfile(std::filesystem::path const &path) const {
+  auto temporary = path;
+  temporary += ".tmp";
+
+  {
+    std::ofstream ofstream{temporary};
+    write(ofstream);
+    if (!ofstream) {
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  return !error;
+}
+
+EmulatorMetrics::EmulatorMetrics(Metrics &metrics)
+    : instructions(metrics.counter("chip_8_instructions_total",
+                                   "Emulated instructions executed.")),
+      frames(metrics.counter("chip_8_frames_total", "Emulated frames run.")),
+      illegal_opcodes(metrics.counter("chip_8_illegal_opcodes_total",
+                                      "Illegal opcodes fetched.")),
+      frame_time(metrics.histogram("chip_8_frame_seconds",
+                                   "Host time spent per emulated frame.")) {}
+
+void EmulatorMetrics::record(Emulator const &emulator) noexcept {
+  auto delta = [](uint64_t &last, uint64_t value) {
+    return value - std::exchange(last, value);
+  };
+
+  instructions.add(delta(_instructions, emulator.instructions));
+  frames.add(delta(_frames, emulator.frames));
+  illegal_opcodes.add(delta(_illegal_opcodes, emulator.illegal_opcodes));
+}
+
+MetricsServer::MetricsServer(int fd, std::filesystem::path path,
+                             Metrics const &metrics)
+    : _fd(fd), _path(std::move(path)), _metrics(metrics),
+      _thread([this](std::stop_token stop) { _serve(stop); }) {}
+
+MetricsServer::~MetricsServer() noexcept {
+  _thread.request_stop();
+  _thread.join();
+  close(_fd);
+  unlink(_path.c_str());
+}
+
+std::unique_ptr<MetricsServer>
+MetricsServer::open(std::filesystem::path const &path,
+                    Metrics const &metrics) {
+  auto fd = listen_unix(path);
+  if (!fd) {
+    return nullptr;
+  }
+
+  return std::unique_ptr<MetricsServer>{new MetricsServer{*fd, path, metrics}};
+}
+
+void MetricsServer::_serve(std::stop_token stop) const {
+  while (!stop.stop_requested()) {
+    pollfd pollfd{_fd, POLLIN, 0};
+    if (poll(&pollfd, 1, _POLL_TIMEOUT) <= 0) {
+      continue;
+    }
+
+    auto client = accept4(_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (client < 0) {
+      continue;
+    }
+
+    std::ostringstream text;
+    _metrics.write(text);
+    auto body = text.str();
+
+    for (size_t written = 0; written < body.size();) {
+      auto result = send(client, body.data() + written, body.size() - written,
+                         MSG_NOSIGNAL);
+      if (result <= 0) {
+        break;
+      }
+      written += result;
+    }
+    close(client);
+  }
+}
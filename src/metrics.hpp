@@ -0,0 +1,129 @@
+#pragma once
+
+#include "emulator.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stop_token>
+#include <string>
+#include <thread>
+
+namespace chip_8 {
+
+class Counter {
+public:
+  void add(uint64_t value = 1) noexcept {
+    _value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]]
+  uint64_t value() const noexcept {
+    return _value.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> _value = 0;
+};
+
+class Histogram {
+public:
+  using Duration = std::chrono::steady_clock::duration;
+
+  size_t static constexpr BUCKETS = 0x18;
+
+  void observe(Duration duration) noexcept;
+
+  [[nodiscard]]
+  uint64_t count() const noexcept;
+
+  [[nodiscard]]
+  std::chrono::microseconds sum() const noexcept {
+    return std::chrono::microseconds{_sum.load(std::memory_order_relaxed)};
+  }
+
+  [[nodiscard]]
+  std::chrono::microseconds quantile(double quantile) const noexcept;
+
+  [[nodiscard]]
+  std::array<uint64_t, BUCKETS> buckets() const noexcept;
+
+  [[nodiscard]]
+  std::chrono::microseconds static constexpr bound(size_t bucket) noexcept {
+    return std::chrono::microseconds{uint64_t{1} << bucket};
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKETS> _buckets{};
+  std::atomic<uint64_t> _sum = 0;
+};
+
+class Metrics {
+public:
+  Counter &counter(std::string name, std::string help);
+
+  Histogram &histogram(std::string name, std::string help);
+
+  void write(std::ostream &ostream) const;
+
+  bool write_textfile(std::filesystem::path const &path) const;
+
+private:
+  template <typename T> struct Family {
+    Family(std::string name, std::string help)
+        : name(std::move(name)), help(std::move(help)) {}
+
+    std::string name;
+    std::string help;
+    T metric;
+  };
+
+  mutable std::mutex _mutex;
+  std::deque<Family<Counter>> _counters;
+  std::deque<Family<Histogram>> _histograms;
+};
+
+class EmulatorMetrics {
+public:
+  explicit EmulatorMetrics(Metrics &metrics);
+
+  void record(Emulator const &emulator) noexcept;
+
+  Counter &instructions;
+  Counter &frames;
+  Counter &illegal_opcodes;
+  Histogram &frame_time;
+
+private:
+  uint64_t _instructions = 0;
+  uint64_t _frames = 0;
+  uint64_t _illegal_opcodes = 0;
+};
+
+class MetricsServer {
+public:
+  ~MetricsServer() noexcept;
+
+  [[nodiscard]]
+  static std::unique_ptr<MetricsServer> open(std::filesystem::path const &path,
+                                             Metrics const &metrics);
+
+private:
+  MetricsServer(int fd, std::filesystem::path path, Metrics const &metrics);
+
+  void _serve(std::stop_token stop) const;
+
+  int static constexpr _POLL_TIMEOUT = 100;
+
+  int _fd;
+  std::filesystem::path _path;
+  Metrics const &_metrics;
+  std::jthread _thread;
+};
+} // namespace chip_8
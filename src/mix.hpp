@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace chip_8 {
+
+// splitmix64 finalizer
+[[nodiscard]]
+uint64_t constexpr mix(uint64_t value) noexcept {
+  value += 0x9E3779B97F4A7C15;
+  value = (value ^ value >> 30) * 0xBF58476D1CE4E5B9;
+  value = (value ^ value >> 27) * 0x94D049BB133111EB;
+  return value ^ value >> 31;
+}
+} // namespace chip_8
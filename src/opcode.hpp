@@ -22,6 +22,8 @@ public:
 
   uint8_t constexpr nn() const noexcept { return _value & 0x00FF; }
 
+  uint16_t constexpr value() const noexcept { return _value; }
+
 private:
   uint16_t _value;
 };
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <thread>
+#include <vector>
+
+namespace chip_8 {
+
+void parallel_for(size_t count, std::invocable<size_t> auto &&function) {
+  std::atomic<size_t> next = 0;
+  auto worker = [&] {
+    for (auto i = next++; i < count; i = next++) {
+      function(i);
+    }
+  };
+
+  auto threads_size = std::min<size_t>(
+      count, std::max(1u, std::thread::hardware_concurrency()));
+
+  std::vector<std::jthread> threads;
+  for (size_t i = 1; i < threads_size; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+}
+} // namespace chip_8
@@ -0,0 +1,76 @@
+#include "profiler.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <string>
+
+using namespace chip_8;
+
+Profiler::Profiler() { _frames.push_back({_ROOT, 0, 0}); }
+
+void Profiler::_call(uint16_t location) noexcept {
+  uint64_t key = uint64_t{_frame} << 16 | location;
+
+  try {
+    auto [it, inserted] = _children.try_emplace(key, _frames.size());
+    if (inserted) {
+      _frames.push_back({_frame, location, 0});
+    }
+    _frame = it->second;
+  } catch (std::exception const &) {
+    return;
+  }
+
+  _max_depth = std::max(_max_depth, ++_depth);
+}
+
+void Profiler::write_json(std::ostream &ostream) const {
+  ostream << "{\n  \"opcodes\": {";
+  for (size_t i = 0; i < _OPCODES_SIZE; i++) {
+    ostream << (i ? ", " : "") << "\"0x" << hex(i, 1)
+            << "\": " << _opcode_counts[i];
+  }
+
+  ostream << "},\n  \"locations\": {";
+  bool first = true;
+  for (size_t i = 0; i < _LOCATIONS_SIZE; i++) {
+    if (_location_counts[i]) {
+      ostream << (first ? "" : ", ") << "\"0x" << hex(i, 3)
+              << "\": " << _location_counts[i];
+      first = false;
+    }
+  }
+
+  ostream << "},\n  \"draw_intervals\": {";
+  first = true;
+  for (size_t i = 0; i < _INTERVALS_SIZE; i++) {
+    if (_draw_intervals[i]) {
+      uint64_t upper = i == 0                     ? 0
+                       : i < std::numeric_limits<uint64_t>::digits
+                           ? (uint64_t{1} << i) - 1
+                           : std::numeric_limits<uint64_t>::max();
+      ostream << (first ? "" : ", ") << "\"" << upper
+              << "\": " << _draw_intervals[i];
+      first = false;
+    }
+  }
+
+  ostream << "},\n  \"max_call_depth\": " << _max_depth << "\n}\n";
+}
+
+void Profiler::write_folded(std::ostream &ostream) const {
+  for (auto &&frame : _frames) {
+    if (!frame.count) {
+      continue;
+    }
+
+    std::string stack;
+    for (auto *it = &frame; it != &_frames[_ROOT]; it = &_frames[it->parent]) {
+      stack.insert(0, ";0x" + hex(it->location, 3));
+    }
+
+    ostream << "main" << stack << " " << frame.count << "\n";
+  }
+}
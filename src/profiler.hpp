@@ -0,0 +1,81 @@
+#pragma once
+
+#include "opcode.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace chip_8 {
+
+class Profiler {
+public:
+  Profiler();
+
+  // Only a completed 2NNN or 00EE moves the call tree, so a call that traps
+  // on a full stack never shows up as a frame
+  void constexpr record(uint16_t location, Opcode const &opcode,
+                        bool completed) noexcept {
+    _opcode_counts[opcode.a()]++;
+    _location_counts[location % _LOCATIONS_SIZE]++;
+    _frames[_frame].count++;
+    _since_draw++;
+
+    switch (opcode.a()) {
+    case 0x0:
+      if (completed && opcode.nnn() == 0x0EE) {
+        _return();
+      }
+      break;
+    case 0x2:
+      if (completed) {
+        _call(opcode.nnn());
+      }
+      break;
+    case 0xD:
+      _draw_intervals[std::bit_width(_since_draw)]++;
+      _since_draw = 0;
+      break;
+    }
+  }
+
+  void write_json(std::ostream &ostream) const;
+
+  void write_folded(std::ostream &ostream) const;
+
+private:
+  struct Frame {
+    uint32_t parent;
+    uint16_t location;
+    uint64_t count;
+  };
+
+  void _call(uint16_t location) noexcept;
+
+  void constexpr _return() noexcept {
+    if (_frame != _ROOT) {
+      _frame = _frames[_frame].parent;
+      _depth--;
+    }
+  }
+
+  size_t static constexpr _OPCODES_SIZE = 0x10;
+  size_t static constexpr _LOCATIONS_SIZE = 0x1000;
+  size_t static constexpr _INTERVALS_SIZE = 0x41;
+  uint32_t static constexpr _ROOT = 0;
+
+  std::array<uint64_t, _OPCODES_SIZE> _opcode_counts{};
+  std::array<uint64_t, _LOCATIONS_SIZE> _location_counts{};
+  std::array<uint64_t, _INTERVALS_SIZE> _draw_intervals{};
+  uint64_t _since_draw = 0;
+
+  std::vector<Frame> _frames;
+  std::unordered_map<uint64_t, uint32_t> _children;
+  uint32_t _frame = _ROOT;
+  size_t _depth = 0;
+  size_t _max_depth = 0;
+};
+} // namespace chip_8
@@ -0,0 +1,397 @@
+#include "remote.hpp"
+#include "unix_socket.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace chip_8;
+
+namespace {
+size_t constexpr DELTA_SIZE = Screen::HEIGHT * sizeof(uint64_t);
+size_t constexpr MAX_RUN = 0xFF;
+
+std::array<uint8_t, DELTA_SIZE> xor_bytes(Rows const &previous,
+                                          Rows const &current) noexcept {
+  std::array<uint8_t, DELTA_SIZE> bytes;
+  for (size_t y = 0; y < Screen::HEIGHT; y++) {
+    auto row = previous[y] ^ current[y];
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+      bytes[y * sizeof(uint64_t) + i] = row >> 8 * i;
+    }
+  }
+
+  return bytes;
+}
+
+std::optional<uint8_t> parse_key(std::string const &key) {
+  if (key.size() != 1) {
+    return std::nullopt;
+  }
+
+  auto digit = std::string_view{"0123456789ABCDEF"}.find(
+      char(std::toupper(key.front())));
+  if (digit == std::string_view::npos) {
+    return std::nullopt;
+  }
+
+  return digit;
+}
+
+// Plain decimal only, so "-1" is rejected instead of wrapping to SIZE_MAX
+std::optional<size_t> parse_count(std::string const &text, size_t max) {
+  size_t value;
+  auto end = text.data() + text.size();
+  auto [last, error] = std::from_chars(text.data(), end, value);
+  if (error != std::errc{} || last != end || value > max) {
+    return std::nullopt;
+  }
+
+  return value;
+}
+} // namespace
+
+// Tokens of <zero bytes to skip> <literal count> <literals>, trailing zeros
+// omitted, so an unchanged screen encodes to nothing
+std::vector<uint8_t> chip_8::encode_delta(Rows const &previous,
+                                          Rows const &current) {
+  auto bytes = xor_bytes(previous, current);
+  auto end = DELTA_SIZE;
+  while (end && !bytes[end - 1]) {
+    end--;
+  }
+
+  std::vector<uint8_t> delta;
+  for (size_t position = 0; position < end;) {
+    size_t skip = 0;
+    for (; position < end && !bytes[position] && skip < MAX_RUN; position++) {
+      skip++;
+    }
+
+    auto literals = position;
+    for (; position < end && position - literals < MAX_RUN &&
+           (bytes[position] ||
+            (position + 1 < end && bytes[position + 1]));
+         position++) {
+    }
+
+    delta.push_back(skip);
+    delta.push_back(position - literals);
+    delta.insert(delta.end(), bytes.begin() + literals,
+                 bytes.begin() + position);
+  }
+
+  return delta;
+}
+
+std::optional<Rows> chip_8::apply_delta(Rows const &previous,
+                                        std::span<uint8_t const> delta) {
+  std::array<uint8_t, DELTA_SIZE> bytes{};
+  size_t position = 0;
+
+  for (auto it = delta.begin(); it != delta.end();) {
+    if (delta.end() - it < 2) {
+      return std::nullopt;
+    }
+    position += *it++;
+    size_t count = *it++;
+
+    if (position + count > DELTA_SIZE || size_t(delta.end() - it) < count) {
+      return std::nullopt;
+    }
+    std::copy_n(it, count, bytes.begin() + position);
+    it += count;
+    position += count;
+  }
+
+  auto rows = previous;
+  for (size_t y = 0; y < Screen::HEIGHT; y++) {
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+      rows[y] ^= uint64_t{bytes[y * sizeof(uint64_t) + i]} << 8 * i;
+    }
+  }
+
+  return rows;
+}
+
+RemoteServer::RemoteServer(int fd, std::filesystem::path path)
+    : _fd(fd), _path(std::move(path)) {}
+
+RemoteServer::~RemoteServer() noexcept {
+  for (auto &&client : _clients) {
+    close(client.fd);
+  }
+  close(_fd);
+  unlink(_path.c_str());
+}
+
+std::unique_ptr<RemoteServer>
+RemoteServer::open(std::filesystem::path const &path) {
+  auto fd = listen_unix(path, SOCK_NONBLOCK);
+  if (!fd) {
+    return nullptr;
+  }
+
+  return std::unique_ptr<RemoteServer>{new RemoteServer{*fd, path}};
+}
+
+void RemoteServer::poll(int timeout) {
+  // A client with a step in progress is not read from until it finishes, so
+  // its later commands keep their order
+  std::vector<pollfd> pollfds{{_fd, POLLIN, 0}};
+  bool stepping = false;
+  for (auto &&client : _clients) {
+    pollfds.push_back({client.fd,
+                       short((client.step ? 0 : POLLIN) |
+                             (client.output.empty() ? 0 : POLLOUT)),
+                       0});
+    stepping |= client.step.has_value();
+  }
+
+  if (::poll(pollfds.data(), pollfds.size(), stepping ? 0 : timeout) < 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < _clients.size(); i++) {
+    auto events = pollfds[i + 1].revents;
+    if (events & (POLLERR | POLLHUP | POLLNVAL)) {
+      _clients[i].closing = true;
+    }
+    if (events & POLLIN) {
+      _read(_clients[i]);
+    }
+  }
+
+  for (auto &&client : _clients) {
+    _step(client);
+  }
+
+  for (auto &&client : _clients) {
+    _write(client);
+  }
+
+  std::erase_if(_clients, [](Client const &client) {
+    if (client.closing) {
+      close(client.fd);
+    }
+    return client.closing;
+  });
+
+  if (pollfds.front().revents & POLLIN) {
+    _accept();
+  }
+}
+
+void RemoteServer::_accept() {
+  while (true) {
+    auto fd = accept4(_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    _clients.push_back({fd, {}, {}, {}, {}});
+  }
+}
+
+void RemoteServer::_read(Client &client) {
+  std::array<char, 0x1000> buffer;
+  auto result = recv(client.fd, buffer.data(), buffer.size(), 0);
+  if (result <= 0) {
+    client.closing = result == 0 || (errno != EAGAIN && errno != EINTR);
+    return;
+  }
+  client.input.append(buffer.data(), result);
+
+  _process(client);
+  if (!client.step && client.input.size() > MAX_LINE) {
+    client.closing = true;
+  }
+}
+
+void RemoteServer::_process(Client &client) {
+  size_t start = 0;
+  for (auto end = client.input.find('\n');
+       end != std::string::npos && !client.closing && !client.step;
+       end = client.input.find('\n', start)) {
+    _execute(client, std::string_view{client.input}.substr(start, end - start));
+    start = end + 1;
+  }
+  client.input.erase(0, start);
+}
+
+void RemoteServer::_step(Client &client) {
+  if (!client.step || client.closing) {
+    return;
+  }
+
+  auto &&[id, frames] = *client.step;
+  auto &&emulator = _instances[id]->emulator;
+  auto batch = std::min(frames, MAX_STEP_FRAMES);
+  for (size_t frame = 0; frame < batch; frame++) {
+    emulator.run_frame();
+  }
+  frames -= batch;
+  _stream(id);
+
+  if (!frames) {
+    client.step.reset();
+    client.output += "OK " + std::to_string(emulator.frames) + "\n";
+    _process(client);
+  }
+}
+
+void RemoteServer::_write(Client &client) {
+  while (!client.output.empty()) {
+    auto result = send(client.fd, client.output.data(), client.output.size(),
+                       MSG_NOSIGNAL);
+    if (result < 0) {
+      client.closing |= errno != EAGAIN && errno != EINTR;
+      return;
+    }
+    client.output.erase(0, result);
+  }
+}
+
+void RemoteServer::_execute(Client &client, std::string_view line) {
+  std::istringstream istringstream{std::string{line}};
+  std::vector<std::string> args;
+  for (std::string arg; istringstream >> arg;) {
+    args.push_back(std::move(arg));
+  }
+  if (args.empty()) {
+    return;
+  }
+
+  auto &&command = args.front();
+  auto reply = [&](std::string const &text) { client.output += text + "\n"; };
+
+  if (command == "quit") {
+    client.closing = true;
+    return;
+  }
+  if (command == "new") {
+    if (_instances.size() >= MAX_INSTANCES) {
+      reply("ERR too many instances");
+      return;
+    }
+    _instances.push_back(std::make_unique<Instance>());
+    reply("OK " + std::to_string(_instances.size() - 1));
+    return;
+  }
+
+  auto id = args.size() >= 2 ? parse_count(args[1], _instances.size() - 1)
+                             : std::nullopt;
+  if (_instances.empty() || !id) {
+    reply("ERR unknown instance");
+    return;
+  }
+
+  auto &&instance = *_instances[*id];
+  auto &&emulator = instance.emulator;
+
+  try {
+    if (command == "load" && args.size() == 3) {
+      auto program = read_program(args[2]);
+      if (!program) {
+        reply("ERR not a loadable ROM");
+        return;
+      }
+      emulator.load_program(*program);
+      reply("OK");
+      _stream(*id);
+    } else if ((command == "press" || command == "release") &&
+               args.size() == 3) {
+      auto key = parse_key(args[2]);
+      if (!key) {
+        reply("ERR bad key");
+        return;
+      }
+      emulator.cpu.keyboard[*key] = command == "press";
+      reply("OK");
+    } else if (command == "step" && args.size() <= 3) {
+      auto frames = args.size() == 3 ? parse_count(args[2], MAX_STEP)
+                                     : std::optional<size_t>{1};
+      if (!frames) {
+        reply("ERR bad frame count");
+        return;
+      }
+      client.step = Step{*id, *frames};
+    } else if (command == "watch" && args.size() == 2) {
+      reply("OK");
+      client.watches.push_back({*id, {}});
+      _send_frame(client, client.watches.back());
+    } else if (command == "unwatch" && args.size() == 2) {
+      std::erase_if(client.watches,
+                    [&](Watch const &watch) { return watch.instance == *id; });
+      reply("OK");
+    } else if (command == "snapshot" && args.size() == 2) {
+      if (instance.snapshots.size() >= MAX_SNAPSHOTS) {
+        reply("ERR too many snapshots");
+        return;
+      }
+      instance.snapshots.push_back(emulator.cpu);
+      reply("OK " + std::to_string(instance.snapshots.size() - 1));
+    } else if (command == "restore" && args.size() == 3) {
+      auto slot = parse_count(args[2], instance.snapshots.size() - 1);
+      if (instance.snapshots.empty() || !slot) {
+        reply("ERR unknown snapshot");
+        return;
+      }
+      emulator.cpu = instance.snapshots[*slot];
+      reply("OK");
+      _stream(*id);
+    } else if (command == "state" && args.size() == 2) {
+      auto &&cpu = emulator.cpu;
+      std::ostringstream state;
+      state << std::hex << std::uppercase << std::setfill('0') << "OK pc="
+            << std::setw(3) << cpu.program_counter << " i=" << std::setw(3)
+            << cpu.index << " v=";
+      for (auto value : cpu.registers) {
+        state << std::setw(2) << +value;
+      }
+      state << std::dec << " dt=" << +cpu.timers[0] << " st=" << +cpu.timers[1]
+            << " sp=" << +cpu.stack_pointer
+            << " trap=" << +std::to_underlying(cpu.trap)
+            << " frames=" << emulator.frames << std::hex
+            << " fingerprint=" << std::setw(16) << cpu.fingerprint();
+      reply(state.str());
+    } else {
+      reply("ERR bad command");
+    }
+  } catch (std::exception const &) {
+    reply("ERR bad argument");
+  }
+}
+
+void RemoteServer::_stream(size_t instance) {
+  for (auto &&client : _clients) {
+    for (auto &&watch : client.watches) {
+      if (watch.instance == instance) {
+        _send_frame(client, watch);
+      }
+    }
+  }
+}
+
+void RemoteServer::_send_frame(Client &client, Watch &watch) {
+  if (client.output.size() > MAX_PENDING) {
+    return;
+  }
+
+  auto &&emulator = _instances[watch.instance]->emulator;
+  auto rows = emulator.cpu.screen.rows();
+  auto delta = encode_delta(watch.sent, rows);
+  watch.sent = rows;
+
+  client.output += "FRAME " + std::to_string(watch.instance) + " " +
+                   std::to_string(emulator.frames) + " " +
+                   std::to_string(delta.size()) + "\n";
+  client.output.append(delta.begin(), delta.end());
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "emulator.hpp"
+#include "screen.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace chip_8 {
+
+using Rows = std::array<uint64_t, Screen::HEIGHT>;
+
+[[nodiscard]]
+std::vector<uint8_t> encode_delta(Rows const &previous, Rows const &current);
+
+[[nodiscard]]
+std::optional<Rows> apply_delta(Rows const &previous,
+                                std::span<uint8_t const> delta);
+
+class RemoteServer {
+public:
+  size_t static constexpr MAX_LINE = 0x1000;
+  size_t static constexpr MAX_PENDING = 0x100000;
+  size_t static constexpr MAX_STEP_FRAMES = 60;
+  size_t static constexpr MAX_STEP = 0x10000;
+  size_t static constexpr MAX_INSTANCES = 0x100;
+  size_t static constexpr MAX_SNAPSHOTS = 0x100;
+
+  RemoteServer(RemoteServer const &) = delete;
+  RemoteServer &operator=(RemoteServer const &) = delete;
+
+  ~RemoteServer() noexcept;
+
+  [[nodiscard]]
+  static std::unique_ptr<RemoteServer> open(std::filesystem::path const &path);
+
+  void poll(int timeout);
+
+private:
+  struct Instance {
+    Emulator emulator;
+    std::vector<Cpu> snapshots;
+  };
+
+  struct Watch {
+    size_t instance;
+    Rows sent;
+  };
+
+  struct Step {
+    size_t instance;
+    size_t frames;
+  };
+
+  struct Client {
+    int fd;
+    std::string input;
+    std::string output;
+    std::vector<Watch> watches;
+    std::optional<Step> step;
+    bool closing = false;
+  };
+
+  RemoteServer(int fd, std::filesystem::path path);
+
+  void _accept();
+
+  void _read(Client &client);
+
+  void _process(Client &client);
+
+  void _step(Client &client);
+
+  void _write(Client &client);
+
+  void _execute(Client &client, std::string_view line);
+
+  void _stream(size_t instance);
+
+  void _send_frame(Client &client, Watch &watch);
+
+  int _fd;
+  std::filesystem::path _path;
+  std::vector<std::unique_ptr<Instance>> _instances;
+  std::vector<Client> _clients;
+};
+} // namespace chip_8
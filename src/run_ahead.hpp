@@ -0,0 +1,31 @@
+#pragma once
+
+#include "emulator.hpp"
+
+namespace chip_8 {
+
+class RunAhead {
+public:
+  bool run(Emulator const &emulator, size_t frames) {
+    if (_emulator.timing() != emulator.timing()) {
+      _emulator.set_timing(emulator.timing());
+    }
+    _emulator.cpu = emulator.cpu;
+
+    bool should_draw = false;
+    for (size_t i = 0; i < frames; i++) {
+      should_draw |= _emulator.run_frame();
+    }
+
+    return should_draw;
+  }
+
+  [[nodiscard]]
+  Screen const &screen() const noexcept {
+    return _emulator.cpu.screen;
+  }
+
+private:
+  Emulator _emulator;
+};
+} // namespace chip_8
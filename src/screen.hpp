@@ -1,7 +1,11 @@
 #pragma once
 
+#include "mix.hpp"
+
+#include <array>
 #include <bitset>
 #include <cassert>
+#include <cstdint>
 #include <ranges>
 
 namespace chip_8 {
@@ -9,7 +13,13 @@ using Sprite = std::bitset<8>;
 
 class Screen {
 public:
-  void constexpr clear_buffer() noexcept { _buffer.reset(); }
+  size_t static constexpr WIDTH = 64;
+  size_t static constexpr HEIGHT = 32;
+
+  void constexpr clear_buffer() noexcept {
+    _buffer.reset();
+    _fingerprint = 0;
+  }
 
   bool constexpr draw_sprites(std::ranges::view auto const sprites, size_t x,
                               size_t y) noexcept {
@@ -32,29 +42,47 @@ public:
   }
 
   [[nodiscard]]
-  decltype(auto) operator[](size_t x, size_t y) noexcept {
+  bool operator[](size_t x, size_t y) const noexcept {
     assert(x < WIDTH && y < HEIGHT);
 
     return _buffer[y * WIDTH + x];
   }
 
+  [[nodiscard]]
+  std::array<uint64_t, HEIGHT> constexpr rows() const noexcept {
+    std::array<uint64_t, HEIGHT> rows{};
+    for (size_t y = 0; y < HEIGHT; y++) {
+      for (size_t x = 0; x < WIDTH; x++) {
+        rows[y] |= uint64_t{_buffer[y * WIDTH + x]} << x;
+      }
+    }
+
+    return rows;
+  }
+
+  [[nodiscard]]
+  uint64_t constexpr fingerprint() const noexcept {
+    return _fingerprint;
+  }
+
+  bool operator==(Screen const &) const = default;
+
 private:
   bool constexpr _draw_pixel(bool pixel, size_t x, size_t y) noexcept {
-    if (x >= WIDTH || y >= HEIGHT) {
+    if (!pixel || x >= WIDTH || y >= HEIGHT) {
       return false;
     }
 
-    auto collision = pixel && operator[](x, y);
-    operator[](x, y) = pixel ^ operator[](x, y);
+    auto position = y * WIDTH + x;
+    bool collision = _buffer[position];
+    _buffer.flip(position);
+    _fingerprint ^= mix(position);
 
     return collision;
   }
 
-public:
-  size_t static constexpr WIDTH = 64;
-  size_t static constexpr HEIGHT = 32;
-
 private:
   std::bitset<WIDTH * HEIGHT> _buffer;
+  uint64_t _fingerprint = 0;
 };
 } // namespace chip_8
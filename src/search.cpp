@@ -0,0 +1,153 @@
+#include "search.hpp"
+#include "emulator.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+using namespace chip_8;
+
+Fork::Fork(Cpu const &cpu) {
+  _store_registers(cpu);
+  for (size_t page = 0; page < PAGES; page++) {
+    Page copy;
+    std::copy_n(cpu.memory.begin() + page * PAGE_SIZE, PAGE_SIZE,
+                copy.begin());
+    _pages[page] = std::make_shared<Page const>(copy);
+  }
+}
+
+void Fork::load(Cpu &cpu) const noexcept {
+  std::memcpy(static_cast<void *>(&cpu), _registers.data(), _REGISTERS_SIZE);
+  for (size_t page = 0; page < PAGES; page++) {
+    std::ranges::copy(*_pages[page], cpu.memory.begin() + page * PAGE_SIZE);
+  }
+}
+
+Fork Fork::fork(Cpu const &cpu) const {
+  Fork fork;
+  fork._store_registers(cpu);
+
+  for (size_t page = 0; page < PAGES; page++) {
+    auto memory = cpu.memory.begin() + page * PAGE_SIZE;
+    if (std::equal(memory, memory + PAGE_SIZE, _pages[page]->begin())) {
+      fork._pages[page] = _pages[page];
+    } else {
+      Page copy;
+      std::copy_n(memory, PAGE_SIZE, copy.begin());
+      fork._pages[page] = std::make_shared<Page const>(copy);
+    }
+  }
+
+  return fork;
+}
+
+size_t Fork::shared_pages(Fork const &other) const noexcept {
+  size_t shared = 0;
+  for (size_t page = 0; page < PAGES; page++) {
+    shared += _pages[page] == other._pages[page];
+  }
+
+  return shared;
+}
+
+void Fork::_store_registers(Cpu const &cpu) noexcept {
+  std::memcpy(_registers.data(), static_cast<void const *>(&cpu),
+              _REGISTERS_SIZE);
+}
+
+namespace {
+struct Node {
+  Fork state;
+  std::vector<uint16_t> inputs;
+};
+
+enum class Outcome { NONE, TRAP, GOAL };
+
+struct Child {
+  std::optional<Node> node;
+  uint64_t hash = 0;
+  Outcome outcome = Outcome::NONE;
+};
+} // namespace
+
+SearchResult chip_8::search(Cpu const &root, SearchOptions const &options,
+                            std::function<bool(Cpu const &)> const &goal) {
+  SearchResult result;
+  if (goal(root)) {
+    result.state = Fork{root};
+    return result;
+  }
+
+  std::vector<Node> frontier;
+  frontier.push_back({Fork{root}, {}});
+  std::unordered_set<uint64_t> seen{root.fingerprint()};
+
+  auto inputs_size = options.inputs.size();
+  for (size_t depth = 0; depth < options.depth && !frontier.empty();
+       depth++) {
+    std::vector<Child> children(frontier.size() * inputs_size);
+
+    parallel_for(children.size(), [&](size_t i) {
+      auto &&parent = frontier[i / inputs_size];
+      auto input = options.inputs[i % inputs_size];
+
+      Emulator static thread_local emulator;
+      if (emulator.timing() != options.timing) {
+        emulator.set_timing(options.timing);
+      }
+
+      auto &&cpu = emulator.cpu;
+      parent.state.load(cpu);
+      for (size_t key = 0; key < cpu.keyboard.size(); key++) {
+        cpu.keyboard[key] = input >> key & 1;
+      }
+
+      for (size_t frame = 0; frame < options.frames_per_input; frame++) {
+        emulator.run_frame();
+      }
+
+      auto &&child = children[i];
+      if (cpu.trap != Trap::NONE) {
+        child.outcome = Outcome::TRAP;
+        return;
+      }
+
+      auto inputs = parent.inputs;
+      inputs.push_back(input);
+      child.node = Node{parent.state.fork(cpu), std::move(inputs)};
+      child.hash = cpu.fingerprint();
+      child.outcome = goal(cpu) ? Outcome::GOAL : Outcome::NONE;
+    });
+
+    result.explored += children.size();
+
+    std::vector<Node> next;
+    for (auto &&child : children) {
+      if (child.outcome == Outcome::TRAP) {
+        result.traps++;
+        continue;
+      }
+
+      if (child.outcome == Outcome::GOAL) {
+        result.inputs = std::move(child.node->inputs);
+        result.state = std::move(child.node->state);
+        return result;
+      }
+
+      if (!seen.insert(child.hash).second) {
+        result.duplicates++;
+        continue;
+      }
+
+      if (next.size() < options.max_frontier) {
+        next.push_back(std::move(*child.node));
+      }
+    }
+
+    frontier = std::move(next);
+  }
+
+  return result;
+}
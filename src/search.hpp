@@ -0,0 +1,66 @@
+#pragma once
+
+#include "cpu.hpp"
+#include "timing.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace chip_8 {
+
+static_assert(std::is_standard_layout_v<Cpu>);
+
+class Fork {
+public:
+  size_t static constexpr PAGE_SIZE = 0x100;
+  size_t static constexpr PAGES = Cpu::MEMORY_SIZE / PAGE_SIZE;
+
+  using Page = std::array<uint8_t, PAGE_SIZE>;
+
+  explicit Fork(Cpu const &cpu);
+
+  void load(Cpu &cpu) const noexcept;
+
+  [[nodiscard]]
+  Fork fork(Cpu const &cpu) const;
+
+  [[nodiscard]]
+  size_t shared_pages(Fork const &other) const noexcept;
+
+private:
+  Fork() noexcept = default;
+
+  void _store_registers(Cpu const &cpu) noexcept;
+
+  size_t static constexpr _REGISTERS_SIZE = offsetof(Cpu, memory);
+
+  alignas(Cpu) std::array<std::byte, _REGISTERS_SIZE> _registers;
+  std::array<std::shared_ptr<Page const>, PAGES> _pages;
+};
+
+struct SearchOptions {
+  std::vector<uint16_t> inputs;
+  size_t frames_per_input = 10;
+  size_t depth = 8;
+  size_t max_frontier = 0x10000;
+  Timing timing = Timing::fixed();
+};
+
+struct SearchResult {
+  std::vector<uint16_t> inputs;
+  std::optional<Fork> state;
+  size_t explored = 0;
+  size_t duplicates = 0;
+  size_t traps = 0;
+};
+
+[[nodiscard]]
+SearchResult search(Cpu const &root, SearchOptions const &options,
+                    std::function<bool(Cpu const &)> const &goal);
+} // namespace chip_8
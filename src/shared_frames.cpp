@@ -0,0 +1,188 @@
+#include "shared_frames.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace chip_8;
+
+SharedFrames::SharedFrames(void *mapping, size_t length) noexcept
+    : _mapping(mapping), _length(length) {}
+
+SharedFrames::SharedFrames(SharedFrames &&other) noexcept
+    : _mapping(std::exchange(other._mapping, nullptr)),
+      _length(std::exchange(other._length, 0)) {}
+
+SharedFrames &SharedFrames::operator=(SharedFrames &&other) noexcept {
+  std::swap(_mapping, other._mapping);
+  std::swap(_length, other._length);
+  return *this;
+}
+
+SharedFrames::~SharedFrames() noexcept {
+  if (_mapping) {
+    munmap(_mapping, _length);
+  }
+}
+
+std::optional<SharedFrames> SharedFrames::create(std::string const &name,
+                                                 size_t slots) {
+  auto length = sizeof(Slot) * (slots + 1);
+
+  bool created = true;
+  auto fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0 && errno == EEXIST) {
+    created = false;
+    fd = shm_open(name.c_str(), O_RDWR, 0);
+  }
+  if (fd < 0) {
+    return std::nullopt;
+  }
+
+  if (!created) {
+    auto shared_frames = _attach(fd, PROT_READ | PROT_WRITE, slots);
+    close(fd);
+    return shared_frames;
+  }
+
+  if (ftruncate(fd, length) < 0) {
+    close(fd);
+    return std::nullopt;
+  }
+
+  auto mapping =
+      mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return std::nullopt;
+  }
+
+  SharedFrames shared_frames{mapping, length};
+  auto header =
+      new (mapping) Header{{}, _MAGIC, uint32_t(slots), sizeof(Slot)};
+  for (size_t i = 0; i < slots; i++) {
+    new (shared_frames._slots() + i) Slot{};
+  }
+  header->version.store(_VERSION, std::memory_order_release);
+
+  return shared_frames;
+}
+
+std::optional<SharedFrames> SharedFrames::open(std::string const &name) {
+  auto fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+
+  auto shared_frames = _attach(fd, PROT_READ, std::nullopt);
+  close(fd);
+  return shared_frames;
+}
+
+bool SharedFrames::unlink(std::string const &name) noexcept {
+  return shm_unlink(name.c_str()) == 0;
+}
+
+std::optional<SharedFrames> SharedFrames::_attach(
+    int fd, int protection, std::optional<size_t> slots) {
+  // The creator sizes the segment and then publishes the version last, so
+  // an empty segment or a zero version means it is still being set up
+  for (size_t attempt = 0; attempt < _ATTACH_ATTEMPTS; attempt++) {
+    if (attempt) {
+      std::this_thread::sleep_for(_ATTACH_DELAY);
+    }
+
+    struct stat stat;
+    if (fstat(fd, &stat) < 0) {
+      return std::nullopt;
+    }
+    if (size_t(stat.st_size) < sizeof(Slot)) {
+      continue;
+    }
+
+    size_t length = stat.st_size;
+    auto mapping = mmap(nullptr, length, protection, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      return std::nullopt;
+    }
+
+    SharedFrames shared_frames{mapping, length};
+    auto &&header = shared_frames._header();
+    auto version = header.version.load(std::memory_order_acquire);
+    if (version == 0) {
+      continue;
+    }
+
+    if (version != _VERSION || header.magic != _MAGIC ||
+        header.slot_size != sizeof(Slot) ||
+        length != sizeof(Slot) * (size_t{header.slots} + 1) ||
+        (slots && header.slots != *slots)) {
+      return std::nullopt;
+    }
+
+    return shared_frames;
+  }
+
+  return std::nullopt;
+}
+
+void SharedFrames::publish(size_t slot, Cpu const &cpu,
+                           uint64_t frame) noexcept {
+  assert(slot < size());
+
+  auto &&target = _slots()[slot];
+  auto sequence = target.sequence.load(std::memory_order_relaxed);
+
+  target.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  target.state = {frame,           cpu.screen.rows(), cpu.registers,
+                  cpu.program_counter, cpu.index,     cpu.timers};
+
+  target.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+uint32_t SharedFrames::sequence(size_t slot) const noexcept {
+  return _slots()[slot].sequence.load(std::memory_order_acquire);
+}
+
+std::optional<FrameState> SharedFrames::read(size_t slot) const noexcept {
+  assert(slot < size());
+
+  auto &&source = _slots()[slot];
+
+  for (size_t i = 0; i < _READ_ATTEMPTS; i++) {
+    auto before = source.sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+      continue;
+    }
+
+    FrameState state;
+    std::memcpy(&state, &source.state, sizeof(state));
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (source.sequence.load(std::memory_order_relaxed) == before) {
+      return state;
+    }
+  }
+
+  return std::nullopt;
+}
+
+size_t SharedFrames::size() const noexcept { return _header().slots; }
+
+SharedFrames::Header const &SharedFrames::_header() const noexcept {
+  return *static_cast<Header const *>(_mapping);
+}
+
+SharedFrames::Slot *SharedFrames::_slots() const noexcept {
+  return static_cast<Slot *>(_mapping) + 1;
+}
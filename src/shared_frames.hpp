@@ -0,0 +1,90 @@
+#pragma once
+
+#include "cpu.hpp"
+#include "screen.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+namespace chip_8 {
+
+struct FrameState {
+  uint64_t frame;
+  std::array<uint64_t, Screen::HEIGHT> rows;
+  std::array<uint8_t, 0x10> registers;
+  uint16_t program_counter;
+  uint16_t index;
+  std::array<uint8_t, 2> timers;
+};
+
+static_assert(std::is_trivially_copyable_v<FrameState>);
+
+class SharedFrames {
+public:
+  SharedFrames(SharedFrames &&other) noexcept;
+  SharedFrames &operator=(SharedFrames &&other) noexcept;
+  ~SharedFrames() noexcept;
+
+  [[nodiscard]]
+  static std::optional<SharedFrames> create(std::string const &name,
+                                            size_t slots);
+
+  [[nodiscard]]
+  static std::optional<SharedFrames> open(std::string const &name);
+
+  static bool unlink(std::string const &name) noexcept;
+
+  void publish(size_t slot, Cpu const &cpu, uint64_t frame) noexcept;
+
+  [[nodiscard]]
+  uint32_t sequence(size_t slot) const noexcept;
+
+  [[nodiscard]]
+  std::optional<FrameState> read(size_t slot) const noexcept;
+
+  [[nodiscard]]
+  size_t size() const noexcept;
+
+private:
+  struct Header {
+    std::atomic<uint32_t> version;
+    std::array<char, 4> magic;
+    uint32_t slots;
+    uint32_t slot_size;
+  };
+
+  struct alignas(64) Slot {
+    std::atomic<uint32_t> sequence;
+    FrameState state;
+  };
+
+  static_assert(std::atomic<uint32_t>::is_always_lock_free);
+  static_assert(sizeof(Header) <= sizeof(Slot));
+
+  SharedFrames(void *mapping, size_t length) noexcept;
+
+  [[nodiscard]]
+  static std::optional<SharedFrames> _attach(int fd, int protection,
+                                             std::optional<size_t> slots);
+
+  [[nodiscard]]
+  Header const &_header() const noexcept;
+
+  [[nodiscard]]
+  Slot *_slots() const noexcept;
+
+  std::array<char, 4> static constexpr _MAGIC = {'C', '8', 'F', 'B'};
+  uint32_t static constexpr _VERSION = 1;
+  size_t static constexpr _READ_ATTEMPTS = 64;
+  size_t static constexpr _ATTACH_ATTEMPTS = 100;
+  std::chrono::milliseconds static constexpr _ATTACH_DELAY{10};
+
+  void *_mapping;
+  size_t _length;
+};
+} // namespace chip_8
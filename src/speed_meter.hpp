@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+namespace chip_8 {
+
+class SpeedMeter {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  void constexpr add(size_t frames) noexcept { _frames += frames; }
+
+  [[nodiscard]]
+  std::optional<double> sample(Clock::time_point now = Clock::now()) noexcept {
+    std::chrono::duration<double> elapsed = now - _start;
+    if (elapsed < _WINDOW) {
+      return std::nullopt;
+    }
+
+    auto speed = _frames / elapsed.count() / FRAMES_PER_SECOND;
+    _frames = 0;
+    _start = now;
+
+    return speed;
+  }
+
+  void reset(Clock::time_point now = Clock::now()) noexcept {
+    _frames = 0;
+    _start = now;
+  }
+
+  double static constexpr FRAMES_PER_SECOND = 60;
+
+private:
+  std::chrono::duration<double> static constexpr _WINDOW =
+      std::chrono::seconds{1};
+
+  size_t _frames = 0;
+  Clock::time_point _start = Clock::now();
+};
+} // namespace chip_8
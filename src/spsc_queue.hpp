@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <optional>
+
+namespace chip_8 {
+
+template <typename T, size_t N>
+  requires(std::has_single_bit(N))
+class SpscQueue {
+public:
+  bool push(T const &value) noexcept {
+    auto tail = _tail.load(std::memory_order_relaxed);
+    if (tail - _head.load(std::memory_order_acquire) == N) {
+      return false;
+    }
+
+    _buffer[tail % N] = value;
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  [[nodiscard]]
+  std::optional<T> pop() noexcept {
+    auto head = _head.load(std::memory_order_relaxed);
+    if (head == _tail.load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+
+    auto value = _buffer[head % N];
+    _head.store(head + 1, std::memory_order_release);
+    return value;
+  }
+
+private:
+  alignas(64) std::atomic<size_t> _head = 0;
+  alignas(64) std::atomic<size_t> _tail = 0;
+  alignas(64) std::array<T, N> _buffer{};
+};
+} // namespace chip_8
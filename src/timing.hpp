@@ -0,0 +1,84 @@
+#pragma once
+
+#include "opcode.hpp"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace chip_8 {
+
+struct Timing {
+  uint32_t static constexpr INSTRUCTIONS_PER_FRAME = 10;
+
+  uint32_t cycles_per_frame = 0;
+  uint32_t fetch = 0;
+  std::array<uint32_t, 0x10> execute{};
+  uint32_t clear_screen = 0;
+  uint32_t draw_row = 0;
+  uint32_t bcd = 0;
+  uint32_t register_transfer = 0;
+
+  [[nodiscard]]
+  uint32_t constexpr cycles(Opcode const &opcode) const noexcept {
+    auto cycles = fetch + execute[opcode.a()];
+
+    switch (opcode.a()) {
+    case 0x0:
+      // 00E0
+      return cycles + (opcode.nnn() == 0x0E0 ? clear_screen : 0);
+    case 0xD:
+      // DXYN
+      return cycles + draw_row * opcode.n();
+    case 0xF:
+      switch (opcode.nn()) {
+      case 0x33:
+        return cycles + bcd;
+      case 0x55:
+      case 0x65:
+        return cycles + register_transfer * (opcode.x() + 1);
+      default:
+        return cycles;
+      }
+    default:
+      return cycles;
+    }
+  }
+
+  [[nodiscard]]
+  Timing static constexpr fixed(
+      uint32_t instructions_per_frame = INSTRUCTIONS_PER_FRAME) noexcept {
+    return {.cycles_per_frame = instructions_per_frame, .fetch = 1};
+  }
+
+  // 1.7609 MHz clock, 8 clocks per machine cycle
+  [[nodiscard]]
+  Timing static constexpr cosmac_vip() noexcept {
+    return {
+        .cycles_per_frame = 3668,
+        .fetch = 40,
+        .execute = {10, 12, 26, 10, 10, 18, 6, 10, 44, 18, 12, 22, 36, 26, 14,
+                    16},
+        .clear_screen = 3068,
+        .draw_row = 46,
+        .bcd = 64,
+        .register_transfer = 14,
+    };
+  }
+
+  bool operator==(Timing const &) const = default;
+};
+
+[[nodiscard]]
+std::optional<Timing> constexpr parse_timing(std::string_view name) noexcept {
+  if (name == "fixed") {
+    return Timing::fixed();
+  }
+  if (name == "vip") {
+    return Timing::cosmac_vip();
+  }
+
+  return std::nullopt;
+}
+} // namespace chip_8
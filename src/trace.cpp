@@ -0,0 +1,63 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+using namespace chip_8;
+
+namespace {
+std::array<char, 4> constexpr MAGIC = {'C', '8', 'T', 'R'};
+uint32_t constexpr VERSION = 1;
+} // namespace
+
+void Trace::dump(std::ostream &ostream) const {
+  uint32_t count = std::min<uint64_t>(_head, _SIZE);
+
+  ostream.write(MAGIC.data(), MAGIC.size());
+  ostream.write(reinterpret_cast<char const *>(&VERSION), sizeof(VERSION));
+  ostream.write(reinterpret_cast<char const *>(&count), sizeof(count));
+
+  for (auto i = _head - count; i < _head; i++) {
+    ostream.write(reinterpret_cast<char const *>(&_records[i % _SIZE]),
+                  sizeof(TraceRecord));
+  }
+}
+
+bool Trace::dump(std::filesystem::path const &path) const {
+  std::ofstream ofstream{path, std::ios::binary};
+  dump(ofstream);
+
+  return ofstream.good();
+}
+
+std::optional<std::vector<TraceRecord>>
+chip_8::read_trace(std::istream &istream) {
+  std::array<char, 4> magic;
+  uint32_t version, count;
+
+  istream.read(magic.data(), magic.size());
+  istream.read(reinterpret_cast<char *>(&version), sizeof(version));
+  istream.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (!istream || magic != MAGIC || version != VERSION ||
+      count > Trace::SIZE) {
+    return std::nullopt;
+  }
+
+  if (auto position = istream.tellg(); position != -1) {
+    istream.seekg(0, std::ios::end);
+    auto end = istream.tellg();
+    istream.seekg(position);
+    if (end - position < std::streamoff(count * sizeof(TraceRecord))) {
+      return std::nullopt;
+    }
+  }
+
+  std::vector<TraceRecord> records(count);
+  istream.read(reinterpret_cast<char *>(records.data()),
+               count * sizeof(TraceRecord));
+  if (!istream) {
+    return std::nullopt;
+  }
+
+  return records;
+}
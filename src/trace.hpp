@@ -0,0 +1,69 @@
+#pragma once
+
+#include "cpu.hpp"
+#include "opcode.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace chip_8 {
+
+struct TraceRecord {
+  uint16_t program_counter;
+  uint16_t opcode;
+  uint16_t index;
+  uint16_t changed;
+  std::array<uint8_t, 0x10> registers;
+};
+
+static_assert(std::is_trivially_copyable_v<TraceRecord>);
+static_assert(sizeof(TraceRecord) == 24);
+
+class Trace {
+public:
+  void constexpr record(uint16_t location, Opcode const &opcode,
+                        std::array<uint8_t, 0x10> const &registers,
+                        Cpu const &cpu) noexcept {
+    uint16_t changed = 0;
+    for (size_t i = 0; i < registers.size(); i++) {
+      changed |= (registers[i] != cpu.registers[i]) << i;
+    }
+
+    _records[_head % _SIZE] = {location, opcode.value(), cpu.index, changed,
+                               cpu.registers};
+    _head++;
+  }
+
+  void dump(std::ostream &ostream) const;
+
+  bool dump(std::filesystem::path const &path) const;
+
+  void trap() {
+    if (!_dumped && !trap_path.empty()) {
+      _dumped = true;
+      dump(trap_path);
+    }
+  }
+
+  size_t static constexpr SIZE = 0x400;
+
+private:
+  size_t static constexpr _SIZE = SIZE;
+
+  std::array<TraceRecord, _SIZE> _records;
+  uint64_t _head = 0;
+  bool _dumped = false;
+
+public:
+  std::filesystem::path trap_path;
+};
+
+[[nodiscard]]
+std::optional<std::vector<TraceRecord>> read_trace(std::istream &istream);
+} // namespace chip_8
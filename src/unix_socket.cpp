@@ -0,0 +1,56 @@
+#include "unix_socket.hpp"
+
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace chip_8;
+
+namespace {
+bool listening(sockaddr_un const &address) {
+  auto fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return false;
+  }
+
+  bool connected = connect(fd, reinterpret_cast<sockaddr const *>(&address),
+                           sizeof(address)) == 0;
+  close(fd);
+  return connected;
+}
+} // namespace
+
+std::optional<int> chip_8::listen_unix(std::filesystem::path const &path,
+                                       int flags) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.native().size() >= sizeof(address.sun_path)) {
+    return std::nullopt;
+  }
+  std::strcpy(address.sun_path, path.c_str());
+
+  struct stat stat;
+  if (lstat(path.c_str(), &stat) == 0) {
+    if (!S_ISSOCK(stat.st_mode) || listening(address)) {
+      return std::nullopt;
+    }
+    unlink(path.c_str());
+  }
+
+  auto fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | flags, 0);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+
+  if (bind(fd, reinterpret_cast<sockaddr const *>(&address),
+           sizeof(address)) < 0 ||
+      listen(fd, SOMAXCONN) < 0) {
+    close(fd);
+    return std::nullopt;
+  }
+
+  return fd;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+
+namespace chip_8 {
+
+// Binds a listening Unix socket at path, replacing a stale socket left by a
+// previous run but never a regular file or a live server
+[[nodiscard]]
+std::optional<int> listen_unix(std::filesystem::path const &path,
+                               int flags = 0);
+} // namespace chip_8
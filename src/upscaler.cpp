@@ -0,0 +1,137 @@
+#include "upscaler.hpp"
+
+#include <algorithm>
+
+using namespace chip_8;
+
+namespace {
+using Blocks = std::array<uint64_t, 9>;
+
+uint64_t constexpr left(uint64_t row) noexcept { return row << 1 | (row & 1); }
+
+uint64_t constexpr right(uint64_t row) noexcept {
+  return row >> 1 | (row & uint64_t{1} << 63);
+}
+
+uint64_t constexpr eq(uint64_t a, uint64_t b) noexcept { return ~(a ^ b); }
+
+uint64_t constexpr select(uint64_t mask, uint64_t a, uint64_t b) noexcept {
+  return (mask & a) | (~mask & b);
+}
+
+void constexpr scale2x(uint64_t up, uint64_t row, uint64_t down,
+                       Blocks &blocks) noexcept {
+  auto a = up, b = right(row), c = left(row), d = down, p = row;
+
+  blocks[0] = select(eq(c, a) & ~eq(c, d) & ~eq(a, b), a, p);
+  blocks[1] = select(eq(a, b) & ~eq(a, c) & ~eq(b, d), b, p);
+  blocks[2] = select(eq(d, c) & ~eq(d, b) & ~eq(c, a), c, p);
+  blocks[3] = select(eq(b, d) & ~eq(b, a) & ~eq(d, c), d, p);
+}
+
+void constexpr scale3x(uint64_t up, uint64_t row, uint64_t down,
+                       Blocks &blocks) noexcept {
+  auto a = left(up), b = up, c = right(up);
+  auto d = left(row), e = row, f = right(row);
+  auto g = left(down), h = down, i = right(down);
+
+  auto mask = ~eq(b, h) & ~eq(d, f);
+  auto db = eq(d, b), bf = eq(b, f), dh = eq(d, h), hf = eq(h, f);
+
+  blocks[0] = select(mask & db, d, e);
+  blocks[1] = select(mask & ((db & ~eq(e, c)) | (bf & ~eq(e, a))), b, e);
+  blocks[2] = select(mask & bf, f, e);
+  blocks[3] = select(mask & ((db & ~eq(e, g)) | (dh & ~eq(e, a))), d, e);
+  blocks[4] = e;
+  blocks[5] = select(mask & ((bf & ~eq(e, i)) | (hf & ~eq(e, c))), f, e);
+  blocks[6] = select(mask & dh, d, e);
+  blocks[7] = select(mask & ((dh & ~eq(e, i)) | (hf & ~eq(e, g))), h, e);
+  blocks[8] = select(mask & hf, f, e);
+}
+} // namespace
+
+Upscaler::Upscaler(Filter filter) { set_filter(filter); }
+
+bool Upscaler::update(Screen const &screen) {
+  auto rows = screen.rows();
+  bool dirty = !_valid || rows != _rows;
+  if (!dirty && !_fading) {
+    return false;
+  }
+
+  if (dirty) {
+    _rows = rows;
+    _valid = true;
+    _render();
+  }
+  _fade();
+
+  return true;
+}
+
+void Upscaler::set_filter(Filter filter) {
+  _filter = filter;
+  _valid = false;
+  _target.assign(width() * height(), 0);
+  _pixels.assign(width() * height(), 0);
+}
+
+void Upscaler::set_persistence(uint8_t persistence) noexcept {
+  _persistence = persistence;
+}
+
+size_t Upscaler::scale() const noexcept {
+  switch (_filter) {
+  case Filter::SCALE2X:
+    return 2;
+  case Filter::SCALE3X:
+    return 3;
+  default:
+    return 1;
+  }
+}
+
+void Upscaler::_render() {
+  auto scale = this->scale();
+  auto width = this->width();
+
+  Blocks blocks{};
+  for (size_t y = 0; y < Screen::HEIGHT; y++) {
+    auto up = _rows[y ? y - 1 : y];
+    auto row = _rows[y];
+    auto down = _rows[y + 1 < Screen::HEIGHT ? y + 1 : y];
+
+    switch (_filter) {
+    case Filter::SCALE2X:
+      scale2x(up, row, down, blocks);
+      break;
+    case Filter::SCALE3X:
+      scale3x(up, row, down, blocks);
+      break;
+    default:
+      blocks[0] = row;
+      break;
+    }
+
+    for (size_t i = 0; i < scale; i++) {
+      auto line = _target.data() + (y * scale + i) * width;
+      for (size_t j = 0; j < scale; j++) {
+        auto block = blocks[i * scale + j];
+        for (size_t x = 0; x < Screen::WIDTH; x++) {
+          line[x * scale + j] = -(block >> x & 1);
+        }
+      }
+    }
+  }
+}
+
+void Upscaler::_fade() noexcept {
+  bool fading = false;
+  for (size_t i = 0; i < _pixels.size(); i++) {
+    uint8_t decayed = _pixels[i] * _persistence >> 8;
+    _pixels[i] = std::max(_target[i], decayed);
+    fading |= _pixels[i] != _target[i];
+  }
+
+  _fading = fading;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "screen.hpp"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace chip_8 {
+
+enum class Filter { NEAREST, SCALE2X, SCALE3X };
+
+[[nodiscard]]
+std::optional<Filter> constexpr parse_filter(std::string_view name) noexcept {
+  if (name == "nearest") {
+    return Filter::NEAREST;
+  }
+  if (name == "scale2x") {
+    return Filter::SCALE2X;
+  }
+  if (name == "scale3x") {
+    return Filter::SCALE3X;
+  }
+
+  return std::nullopt;
+}
+
+class Upscaler {
+public:
+  explicit Upscaler(Filter filter = Filter::NEAREST);
+
+  bool update(Screen const &screen);
+
+  void set_filter(Filter filter);
+
+  void set_persistence(uint8_t persistence) noexcept;
+
+  [[nodiscard]]
+  size_t scale() const noexcept;
+
+  [[nodiscard]]
+  size_t width() const noexcept {
+    return Screen::WIDTH * scale();
+  }
+
+  [[nodiscard]]
+  size_t height() const noexcept {
+    return Screen::HEIGHT * scale();
+  }
+
+  [[nodiscard]]
+  std::span<uint8_t const> pixels() const noexcept {
+    return _pixels;
+  }
+
+  [[nodiscard]]
+  bool fading() const noexcept {
+    return _fading;
+  }
+
+private:
+  void _render();
+
+  void _fade() noexcept;
+
+  Filter _filter;
+  uint8_t _persistence = 0;
+
+  std::array<uint64_t, Screen::HEIGHT> _rows{};
+  bool _valid = false;
+  bool _fading = false;
+
+  std::vector<uint8_t> _target;
+  std::vector<uint8_t> _pixels;
+};
+} // namespace chip_8
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace chip_8 {
+
+[[nodiscard]]
+std::string constexpr hex(uint64_t value, size_t digits) {
+  std::string result(digits, '0');
+  for (auto it = result.rbegin(); it != result.rend(); it++, value >>= 4) {
+    *it = "0123456789ABCDEF"[value & 0xF];
+  }
+
+  return result;
+}
+
+// Directories expand to the .ch8 files beneath them, other paths are kept
+[[nodiscard]]
+inline std::vector<std::filesystem::path> corpus(
+    std::vector<std::filesystem::path> const &paths) {
+  std::vector<std::filesystem::path> roms;
+  for (auto &&path : paths) {
+    if (!std::filesystem::is_directory(path)) {
+      roms.push_back(path);
+      continue;
+    }
+
+    for (auto &&entry :
+         std::filesystem::recursive_directory_iterator{path}) {
+      if (entry.is_regular_file() && entry.path().extension() == ".ch8") {
+        roms.push_back(entry.path());
+      }
+    }
+  }
+
+  std::ranges::sort(roms);
+  return roms;
+}
+} // namespace chip_8
@@ -0,0 +1,132 @@
+#include "wall.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace chip_8;
+
+Wall::Wall(std::span<std::vector<uint8_t> const> programs,
+           Timing const &timing)
+    : _emulators(programs.size()), _keys(programs.size()),
+      _composed(programs.size()),
+      _columns(std::max<size_t>(
+          1, std::ceil(std::sqrt(double(programs.size()))))),
+      _workers_size(std::clamp<size_t>(std::thread::hardware_concurrency(),
+                                       1, std::max<size_t>(size(), 1))),
+      _start(_workers_size + 1) {
+  for (size_t i = 0; i < size(); i++) {
+    _emulators[i].set_timing(timing);
+    _emulators[i].load_program(programs[i]);
+  }
+
+  for (size_t worker = 0; worker < _workers_size; worker++) {
+    _workers.emplace_back([this, worker] {
+      while (true) {
+        _start.arrive_and_wait();
+        if (_stopping) {
+          return;
+        }
+        _work(worker);
+        _done.fetch_add(1, std::memory_order_release);
+        _done.notify_one();
+      }
+    });
+  }
+}
+
+Wall::~Wall() {
+  finish_frame();
+  _stopping = true;
+  _start.arrive_and_wait();
+}
+
+void Wall::start_frame(size_t frames) {
+  if (_running) {
+    return;
+  }
+
+  for (size_t i = 0; i < size(); i++) {
+    for (size_t key = 0; key < _emulators[i].cpu.keyboard.size(); key++) {
+      _emulators[i].cpu.keyboard[key] = _keys[i] >> key & 1;
+    }
+  }
+
+  _frames = frames;
+  _done.store(0, std::memory_order_relaxed);
+  _running = true;
+  _start.arrive_and_wait();
+}
+
+bool Wall::try_finish_frame() noexcept {
+  if (_running && _done.load(std::memory_order_acquire) == _workers_size) {
+    _running = false;
+  }
+
+  return !_running;
+}
+
+void Wall::finish_frame() noexcept {
+  while (!try_finish_frame()) {
+    _done.wait(_done.load(std::memory_order_relaxed),
+               std::memory_order_relaxed);
+  }
+}
+
+void Wall::set_key(size_t tile, uint8_t key, bool pressed) noexcept {
+  assert(tile < size() && key < 0x10);
+
+  _keys[tile] = pressed ? _keys[tile] | 1 << key : _keys[tile] & ~(1 << key);
+}
+
+void Wall::release_keys(size_t tile) noexcept { _keys[tile] = 0; }
+
+std::vector<size_t> Wall::compose(std::span<uint8_t> atlas, size_t stride) {
+  assert(!_running && stride >= width() && atlas.size() >= stride * height());
+
+  std::vector<size_t> changed;
+  for (size_t tile = 0; tile < size(); tile++) {
+    auto &&screen = _emulators[tile].cpu.screen;
+    if (_composed[tile] == screen.fingerprint()) {
+      continue;
+    }
+    _composed[tile] = screen.fingerprint();
+    changed.push_back(tile);
+
+    auto [left, top, width, height] = rect(tile);
+    auto rows = screen.rows();
+    for (size_t y = 0; y < Screen::HEIGHT; y++) {
+      auto pixels = atlas.begin() + (top + y) * stride + left;
+      for (size_t x = 0; x < Screen::WIDTH; x++) {
+        pixels[x] = rows[y] >> x & 1 ? 0xFF : 0x00;
+      }
+    }
+  }
+
+  return changed;
+}
+
+Wall::Rect Wall::rect(size_t tile) const noexcept {
+  return {tile % _columns * TILE_WIDTH + GAP / 2,
+          tile / _columns * TILE_HEIGHT + GAP / 2, Screen::WIDTH,
+          Screen::HEIGHT};
+}
+
+std::optional<size_t> Wall::tile_at(size_t x, size_t y) const noexcept {
+  auto tile = y / TILE_HEIGHT * _columns + x / TILE_WIDTH;
+  if (x >= width() || tile >= size()) {
+    return std::nullopt;
+  }
+
+  return tile;
+}
+
+void Wall::_work(size_t worker) noexcept {
+  auto n = size();
+  for (auto i = worker * n / _workers_size;
+       i < (worker + 1) * n / _workers_size; i++) {
+    for (size_t frame = 0; frame < _frames; frame++) {
+      _emulators[i].run_frame();
+    }
+  }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "emulator.hpp"
+#include "screen.hpp"
+
+#include <atomic>
+#include <barrier>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace chip_8 {
+
+class Wall {
+public:
+  size_t static constexpr GAP = 2;
+  size_t static constexpr TILE_WIDTH = Screen::WIDTH + GAP;
+  size_t static constexpr TILE_HEIGHT = Screen::HEIGHT + GAP;
+
+  struct Rect {
+    size_t x;
+    size_t y;
+    size_t width;
+    size_t height;
+  };
+
+  explicit Wall(std::span<std::vector<uint8_t> const> programs,
+                Timing const &timing = Timing::fixed());
+
+  Wall(Wall const &) = delete;
+  Wall &operator=(Wall const &) = delete;
+
+  ~Wall();
+
+  void start_frame(size_t frames = 1);
+
+  [[nodiscard]]
+  bool try_finish_frame() noexcept;
+
+  void finish_frame() noexcept;
+
+  void set_key(size_t tile, uint8_t key, bool pressed) noexcept;
+
+  void release_keys(size_t tile) noexcept;
+
+  [[nodiscard]]
+  std::vector<size_t> compose(std::span<uint8_t> atlas, size_t stride);
+
+  [[nodiscard]]
+  size_t size() const noexcept {
+    return _emulators.size();
+  }
+
+  [[nodiscard]]
+  size_t columns() const noexcept {
+    return _columns;
+  }
+
+  [[nodiscard]]
+  size_t rows() const noexcept {
+    return (size() + _columns - 1) / _columns;
+  }
+
+  [[nodiscard]]
+  size_t width() const noexcept {
+    return columns() * TILE_WIDTH;
+  }
+
+  [[nodiscard]]
+  size_t height() const noexcept {
+    return rows() * TILE_HEIGHT;
+  }
+
+  [[nodiscard]]
+  Rect rect(size_t tile) const noexcept;
+
+  [[nodiscard]]
+  std::optional<size_t> tile_at(size_t x, size_t y) const noexcept;
+
+private:
+  void _work(size_t worker) noexcept;
+
+  std::vector<Emulator> _emulators;
+  std::vector<uint16_t> _keys;
+  std::vector<std::optional<uint64_t>> _composed;
+  size_t _columns;
+
+  size_t _workers_size;
+  std::barrier<> _start;
+  std::atomic<size_t> _done = 0;
+  std::vector<std::jthread> _workers;
+  size_t _frames = 0;
+  bool _running = false;
+  bool _stopping = false;
+};
+} // namespace chip_8
@@ -0,0 +1,552 @@
+#include "analysis.hpp"
+#include "disassembler.hpp"
+#include "emulator.hpp"
+#include "hash.hpp"
+#include "lockstep.hpp"
+#include "parser.hpp"
+#include "remote.hpp"
+#include "search.hpp"
+#include "shared_frames.hpp"
+#include "upscaler.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace chip_8;
+
+namespace {
+size_t failures = 0;
+
+void check(bool condition, std::string_view name) {
+  if (!condition) {
+    std::cout << "FAIL " << name << "\n";
+    failures++;
+  }
+}
+
+// FX07, 3X00, 1NNN spin on the delay timer, then count the wait in V2
+std::vector<uint8_t> const IDLE = {0x60, 0x14, 0xF0, 0x15, 0xF1, 0x07, 0x31,
+                                   0x00, 0x12, 0x04, 0x72, 0x01, 0x12, 0x00};
+
+// FX0A into V0, then count the presses in V1
+std::vector<uint8_t> const KEY_WAIT = {0xF0, 0x0A, 0x71, 0x01, 0x12, 0x00};
+
+// DXYN, FX18, FX0A, then an illegal opcode
+std::vector<uint8_t> const EVENTS = {0xD0, 0x01, 0x60, 0x05, 0xF0,
+                                     0x18, 0xF1, 0x0A, 0xFF, 0xFF};
+
+// 7XNN, 1NNN forever
+std::vector<uint8_t> const BUSY = {0x70, 0x01, 0x12, 0x00};
+
+// FX33 and FX55 over an index that moves further each pass
+std::vector<uint8_t> const STORES = {0xA3, 0x00, 0xF0, 0x33, 0x70, 0x07,
+                                     0x71, 0x01, 0xF2, 0x55, 0xF1, 0x1E,
+                                     0x31, 0x40, 0x12, 0x02, 0x12, 0x00};
+
+// Count V0 to 0x10, then 7102 at 0x208 once before looping
+std::vector<uint8_t> const COUNT = {0x60, 0x00, 0x70, 0x01, 0x30, 0x10,
+                                    0x12, 0x02, 0x71, 0x02, 0x12, 0x0A};
+
+// FX55 over the 00E0 at 0x20C, a skip over an illegal opcode, then a loop
+// followed by bytes nothing reaches
+std::vector<uint8_t> const SELF_MODIFYING = {
+    0xA2, 0x0C, 0x60, 0x12, 0x61, 0x34, 0xF1, 0x55, 0x30,
+    0x00, 0xFF, 0xFF, 0x00, 0xE0, 0x12, 0x0E, 0x12, 0x34};
+
+#ifdef CHIP_8_PROFILER
+std::string profile(Profiler const &profiler) {
+  std::ostringstream json;
+  profiler.write_json(json);
+  profiler.write_folded(json);
+  return json.str();
+}
+
+// 2200 recurses until the stack overflows
+void test_profiler() {
+  std::vector<uint8_t> const recurse = {0x22, 0x00};
+  Emulator emulator{recurse};
+  while (emulator.step()) {
+  }
+
+  check(emulator.cpu.trap == Trap::STACK_OVERFLOW &&
+            profile(emulator.profiler).contains("\"max_call_depth\": 16"),
+        "profiler skips calls that overflow the stack");
+
+  emulator.load_program(recurse);
+  check(profile(emulator.profiler) == profile(Profiler{}),
+        "profiler resets on load");
+}
+#endif
+
+void test_disassemble() {
+  bool agrees = true;
+  for (size_t word = 0; word < 0x10000; word++) {
+    Opcode opcode{uint16_t(word)};
+    agrees &= disassemble(opcode).has_value() == decode(opcode).has_value();
+  }
+  check(agrees, "disassembly covers exactly the decoded opcodes");
+
+  check(disassemble(Opcode{0xD125}) == "DRW V1, V2, 5" &&
+            disassemble(Opcode{0xF355}) == "LD [I], V3",
+        "disassembly formats operands");
+}
+
+void step_frame(Emulator &emulator) {
+  for (auto frame = emulator.frames; frame == emulator.frames;) {
+    emulator.step();
+  }
+}
+
+void press(Emulator &emulator, size_t frame) {
+  emulator.cpu.keyboard[5] = frame % 40 < 2;
+}
+
+void test_idle_skip(Timing const &timing) {
+  for (auto &&program : {IDLE, KEY_WAIT}) {
+    Emulator skipped{program}, stepped{program};
+    skipped.set_timing(timing);
+    stepped.set_timing(timing);
+
+    for (size_t frame = 0; frame < 300; frame++) {
+      press(skipped, frame);
+      press(stepped, frame);
+      skipped.run_frame();
+      step_frame(stepped);
+    }
+
+    check(skipped.cpu == stepped.cpu, "idle skip matches stepping");
+    check(skipped.instructions == stepped.instructions,
+          "idle skip counts instructions");
+  }
+}
+
+void test_key_wait() {
+  Emulator emulator{KEY_WAIT};
+  emulator.run_frame();
+  check(emulator.cpu.key_wait == 0 && emulator.cpu.program_counter == 0x202,
+        "FX0A waits without a key");
+  check(emulator.idle(), "FX0A wait is idle");
+
+  emulator.cpu.keyboard[0xB] = true;
+  emulator.run_frame();
+  check(!emulator.cpu.key_wait && emulator.cpu.registers[0] == 0xB,
+        "FX0A stores the pressed key");
+  check(emulator.cpu.registers[1] > 0, "FX0A resumes after the key");
+}
+
+void test_events() {
+  Emulator emulator{EVENTS};
+  std::vector<Event> events;
+  for (auto event : emulator.run()) {
+    events.push_back(event);
+    if (event == Event::FRAME) {
+      emulator.cpu.keyboard[1] = true;
+    }
+    if (event == Event::ILLEGAL_OPCODE) {
+      break;
+    }
+  }
+  check(events == std::vector{Event::DRAW, Event::SOUND, Event::KEY_WAIT,
+                              Event::FRAME, Event::ILLEGAL_OPCODE},
+        "run yields events in order");
+
+  emulator.cpu.trap = Trap::BREAKPOINT;
+  auto suspended = emulator.run();
+  check(suspended.begin() == suspended.end(), "run ends while suspended");
+}
+
+FrameState frame_state(Cpu const &cpu, uint64_t frame) {
+  return {frame,     cpu.screen.rows(), cpu.registers, cpu.program_counter,
+          cpu.index, cpu.timers};
+}
+
+uint64_t fingerprint(FrameState const &state) {
+  Fnv1a fnv1a;
+  fnv1a.update(std::views::single(state.frame));
+  fnv1a.update(state.rows);
+  fnv1a.update(state.registers);
+  fnv1a.update(std::views::single(state.program_counter));
+  fnv1a.update(std::views::single(state.index));
+  fnv1a.update(state.timers);
+
+  return fnv1a.value();
+}
+
+void random_frame(Cpu &cpu, std::mt19937_64 &random) {
+  for (auto &&value : cpu.registers) {
+    value = random();
+  }
+  cpu.index = random();
+  cpu.program_counter = random();
+
+  std::array<Sprite, 0x10> sprites;
+  for (auto &&row : sprites) {
+    row = Sprite(random());
+  }
+  cpu.screen.draw_sprites(std::views::all(sprites), random(), random());
+}
+
+// One thread publishes frames while another reads them, and every frame the
+// reader accepts must be one that was published whole
+void test_shared_frames() {
+  auto name = "/chip_8_core_test." + std::to_string(getpid());
+  auto producer = SharedFrames::create(name, 1);
+  auto consumer = SharedFrames::open(name);
+  SharedFrames::unlink(name);
+  check(producer && consumer, "shared frames attach");
+  if (!producer || !consumer) {
+    return;
+  }
+
+  std::mt19937_64 random{1};
+  std::vector<Cpu> cpus(0x40);
+  for (auto &&cpu : cpus) {
+    random_frame(cpu, random);
+  }
+  auto published = [&](uint64_t frame) {
+    return fingerprint(frame_state(cpus[frame % cpus.size()], frame));
+  };
+
+  uint64_t constexpr FRAMES = 200000;
+  std::atomic<bool> done = false;
+  std::jthread thread{[&] {
+    for (uint64_t frame = 1; frame <= FRAMES; frame++) {
+      producer->publish(0, cpus[frame % cpus.size()], frame);
+    }
+    done.store(true, std::memory_order_release);
+  }};
+
+  size_t reads = 0;
+  bool consistent = true;
+  while (!done.load(std::memory_order_acquire)) {
+    auto state = consumer->read(0);
+    if (state && state->frame) {
+      reads++;
+      consistent &= state->frame <= FRAMES &&
+                    fingerprint(*state) == published(state->frame);
+    }
+  }
+  thread.join();
+
+  check(consistent, "shared frames are never read torn");
+  check(reads > 0, "shared frames are read while publishing");
+
+  auto last = consumer->read(0);
+  check(last && last->frame == FRAMES &&
+            fingerprint(*last) == published(FRAMES),
+        "shared frames end on the last frame");
+}
+
+void test_cpu_copy() {
+  Emulator emulator{STORES};
+  for (size_t frame = 0; frame < 10; frame++) {
+    emulator.run_frame();
+  }
+
+  Cpu copy = emulator.cpu;
+  check(copy == emulator.cpu, "Cpu copies compare equal");
+
+  copy.registers[3] ^= 1;
+  check(copy != emulator.cpu, "Cpu copies diverge");
+}
+
+void test_cadence() {
+  Emulator fixed{BUSY};
+  for (size_t frame = 0; frame < 100; frame++) {
+    fixed.run_frame();
+  }
+  check(fixed.frames == 100 && fixed.instructions ==
+                                   100 * Emulator::INSTRUCTIONS_PER_FRAME,
+        "fixed timing runs a fixed count per frame");
+
+  auto timing = Timing::cosmac_vip();
+  Emulator vip{BUSY};
+  vip.set_timing(timing);
+  for (size_t frame = 0; frame < 100; frame++) {
+    vip.run_frame();
+  }
+
+  auto add = timing.cycles(Opcode{0x7001});
+  auto jump = timing.cycles(Opcode{0x1200});
+  auto cycles =
+      vip.instructions / 2 * (add + jump) + vip.instructions % 2 * add;
+  check(vip.frames == 100 &&
+            cycles == 100 * timing.cycles_per_frame + vip.cpu.cycles,
+        "cycle scheduler accounts every cycle");
+}
+
+bool pixel(std::array<uint64_t, Screen::HEIGHT> const &rows, ptrdiff_t x,
+           ptrdiff_t y) {
+  x = std::clamp<ptrdiff_t>(x, 0, Screen::WIDTH - 1);
+  y = std::clamp<ptrdiff_t>(y, 0, Screen::HEIGHT - 1);
+
+  return rows[y] >> x & 1;
+}
+
+// Per-pixel scale2x and scale3x with clamped edges
+std::vector<bool> reference_upscale(Screen const &screen, size_t scale) {
+  auto rows = screen.rows();
+  auto width = Screen::WIDTH * scale;
+  std::vector<bool> pixels(width * Screen::HEIGHT * scale);
+
+  for (ptrdiff_t y = 0; y < ptrdiff_t(Screen::HEIGHT); y++) {
+    for (ptrdiff_t x = 0; x < ptrdiff_t(Screen::WIDTH); x++) {
+      auto a = pixel(rows, x - 1, y - 1), b = pixel(rows, x, y - 1),
+           c = pixel(rows, x + 1, y - 1), d = pixel(rows, x - 1, y),
+           e = pixel(rows, x, y), f = pixel(rows, x + 1, y),
+           g = pixel(rows, x - 1, y + 1), h = pixel(rows, x, y + 1),
+           i = pixel(rows, x + 1, y + 1);
+
+      std::vector<bool> block;
+      if (scale == 2) {
+        block = {d == b && b != f && d != h ? d : e,
+                 b == f && b != d && f != h ? f : e,
+                 d == h && d != b && h != f ? d : e,
+                 h == f && d != h && b != f ? f : e};
+      } else {
+        bool edge = b != h && d != f;
+        block = {edge && d == b ? d : e,
+                 edge && ((d == b && e != c) || (b == f && e != a)) ? b : e,
+                 edge && b == f ? f : e,
+                 edge && ((d == b && e != g) || (d == h && e != a)) ? d : e,
+                 e,
+                 edge && ((b == f && e != i) || (h == f && e != c)) ? f : e,
+                 edge && d == h ? d : e,
+                 edge && ((d == h && e != i) || (h == f && e != g)) ? h : e,
+                 edge && h == f ? f : e};
+      }
+
+      for (size_t row = 0; row < scale; row++) {
+        for (size_t column = 0; column < scale; column++) {
+          pixels[(y * scale + row) * width + x * scale + column] =
+              block[row * scale + column];
+        }
+      }
+    }
+  }
+
+  return pixels;
+}
+
+void test_upscaler() {
+  std::mt19937_64 random{1};
+  Screen screen;
+  for (size_t sprite = 0; sprite < 40; sprite++) {
+    std::array<Sprite, 4> sprites;
+    for (auto &&row : sprites) {
+      row = Sprite(random());
+    }
+    screen.draw_sprites(std::views::all(sprites), random(), random());
+  }
+
+  Upscaler nearest;
+  nearest.update(screen);
+  bool same = nearest.width() == Screen::WIDTH;
+  for (size_t y = 0; y < Screen::HEIGHT; y++) {
+    for (size_t x = 0; x < Screen::WIDTH; x++) {
+      same &= bool(nearest.pixels()[y * Screen::WIDTH + x]) == screen[x, y];
+    }
+  }
+  check(same, "nearest copies the screen");
+
+  for (auto [filter, scale] :
+       {std::pair{Filter::SCALE2X, 2}, std::pair{Filter::SCALE3X, 3}}) {
+    Upscaler upscaler{filter};
+    upscaler.update(screen);
+    auto expected = reference_upscale(screen, scale);
+
+    bool matches = upscaler.pixels().size() == expected.size();
+    for (size_t i = 0; matches && i < expected.size(); i++) {
+      matches = bool(upscaler.pixels()[i]) == expected[i];
+    }
+    check(matches, scale == 2 ? "scale2x matches the reference"
+                              : "scale3x matches the reference");
+  }
+}
+
+void test_fork() {
+  Emulator emulator{STORES};
+  emulator.run_frame();
+
+  Fork fork{emulator.cpu};
+  Cpu loaded;
+  fork.load(loaded);
+  check(loaded == emulator.cpu, "Fork round trips a Cpu");
+
+  emulator.cpu.write(0x800, 0xAB);
+  auto child = fork.fork(emulator.cpu);
+  check(child.shared_pages(fork) == Fork::PAGES - 1,
+        "Fork shares unchanged pages");
+
+  child.load(loaded);
+  check(loaded == emulator.cpu, "Fork child round trips a Cpu");
+}
+
+// A fault injected into the candidate at 0x208 must be pinned to the step
+// that first executes it
+void test_lockstep() {
+  Cpu root{COUNT};
+
+  Reference reference{root, Timing::fixed()};
+  uint64_t step = 0;
+  for (; reference.cpu.program_counter != 0x208; step++) {
+    reference.step();
+  }
+
+  LockstepOptions options;
+  options.steps = 1000;
+  options.interval = 7;
+  check(!lockstep(root, options).divergence, "lockstep passes unpatched");
+
+  options.patch = [](uint16_t location, Opcode const &,
+                     std::unique_ptr<Instruction> instruction) {
+    return location == 0x208 ? decode(Opcode{0x7103}).value_or(nullptr)
+                             : std::move(instruction);
+  };
+  auto divergence = lockstep(root, options).divergence;
+  check(divergence && divergence->step == step &&
+            divergence->before.program_counter == 0x208 &&
+            divergence->reference.registers[1] == 2 &&
+            divergence->candidate.registers[1] == 3,
+        "lockstep bisects to the diverging step");
+}
+
+void test_fingerprint() {
+  Emulator emulator{STORES};
+  bool consistent = true;
+  for (size_t frame = 0; frame < 200; frame++) {
+    emulator.run_frame();
+
+    Cpu rebuilt;
+    for (size_t location = 0; location < Cpu::MEMORY_SIZE; location++) {
+      rebuilt.write(location, emulator.cpu.memory[location]);
+    }
+    consistent &=
+        rebuilt.memory_fingerprint == emulator.cpu.memory_fingerprint;
+  }
+  check(consistent, "memory fingerprint follows writes");
+
+  Cpu copy = emulator.cpu;
+  check(copy.fingerprint() == emulator.cpu.fingerprint(),
+        "equal states share a fingerprint");
+
+  copy.registers[0xE] ^= 1;
+  check(copy.fingerprint() != emulator.cpu.fingerprint(),
+        "registers change the fingerprint");
+}
+
+Rows rows_from(std::span<uint8_t const> bytes) {
+  Rows rows{};
+  for (size_t i = 0; i < bytes.size(); i++) {
+    rows[i / sizeof(uint64_t)] |= uint64_t{bytes[i]} << 8 * (i % 8);
+  }
+
+  return rows;
+}
+
+bool round_trips(Rows const &previous, Rows const &current) {
+  auto delta = encode_delta(previous, current);
+  return apply_delta(previous, delta) == current;
+}
+
+void test_delta() {
+  std::mt19937_64 random{1};
+  Rows previous;
+  for (auto &&row : previous) {
+    row = random();
+  }
+
+  check(encode_delta(previous, previous).empty(),
+        "unchanged screens encode to nothing");
+
+  // Zero and literal runs on either side of the 255 byte token limit
+  size_t const size = Screen::HEIGHT * sizeof(uint64_t);
+  bool all = true;
+  for (size_t zeros : {0, 1, 254, 255}) {
+    for (size_t literals : {1, 2, 254, 255, 256}) {
+      std::vector<uint8_t> bytes(size);
+      for (size_t i = zeros; i < std::min(zeros + literals, size); i++) {
+        bytes[i] = 0xA5;
+      }
+
+      auto changes = rows_from(bytes);
+      Rows current;
+      for (size_t y = 0; y < Screen::HEIGHT; y++) {
+        current[y] = previous[y] ^ changes[y];
+      }
+      all &= round_trips(previous, current);
+    }
+  }
+  check(all, "delta runs split at the token limit");
+
+  bool random_trips = true;
+  for (size_t trial = 0; trial < 1000; trial++) {
+    auto current = previous;
+    for (size_t flip = random() % 64; flip; flip--) {
+      current[random() % Screen::HEIGHT] ^= uint64_t{1} << random() % 64;
+    }
+    random_trips &= round_trips(previous, current);
+  }
+  check(random_trips, "sparse deltas round trip");
+
+  check(!apply_delta(previous, std::vector<uint8_t>{0xFF, 0x02, 0x01}),
+        "truncated deltas are rejected");
+  check(!apply_delta(previous, std::vector<uint8_t>{0xFF, 0xFF, 0xFF, 0x02}),
+        "deltas past the screen are rejected");
+}
+
+void test_analyse() {
+  auto analysis = analyse(SELF_MODIFYING);
+
+  std::bitset<Cpu::MEMORY_SIZE> reachable;
+  for (size_t location = 0x200; location < 0x210; location += 2) {
+    reachable[location] = true;
+  }
+  check(analysis.reachable == reachable, "analyse traces reachable code");
+
+  check(analysis.illegal.size() == 1 &&
+            analysis.illegal[0].location == 0x20A &&
+            analysis.illegal[0].opcode == 0xFFFF,
+        "analyse finds the illegal opcode");
+
+  check(analysis.writes.size() == 1 && analysis.writes[0].location == 0x206 &&
+            analysis.writes[0].target == 0x20C &&
+            analysis.writes[0].overwrites_code,
+        "analyse finds the self-modifying write");
+}
+} // namespace
+
+int main() {
+#ifdef CHIP_8_PROFILER
+  test_profiler();
+#endif
+  test_disassemble();
+  test_idle_skip(Timing::fixed());
+  test_idle_skip(Timing::cosmac_vip());
+  test_key_wait();
+  test_events();
+  test_shared_frames();
+  test_cpu_copy();
+  test_cadence();
+  test_upscaler();
+  test_fork();
+  test_lockstep();
+  test_fingerprint();
+  test_delta();
+  test_analyse();
+
+  if (failures) {
+    std::cout << failures << " checks failed\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
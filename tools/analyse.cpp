@@ -0,0 +1,231 @@
+#include "analysis.hpp"
+#include "disassembler.hpp"
+#include "emulator.hpp"
+#include "parallel.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+using namespace chip_8;
+
+namespace {
+struct Options {
+  std::vector<std::filesystem::path> roms;
+  size_t ngram = 3;
+  size_t top = 50;
+  bool disassembly = false;
+};
+
+struct Report {
+  std::string json;
+  std::optional<Analysis> analysis;
+};
+
+void usage(char const *name) {
+  std::cerr << "usage: " << name
+            << " [--ngram N] [--top N] [--disassembly] <rom|directory>...\n";
+}
+
+std::optional<Options> parse(int argc, char *argv[]) {
+  Options options;
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string_view arg = argv[i];
+
+      if (arg == "--ngram" && i + 1 < argc) {
+        options.ngram = std::stoul(argv[++i]);
+      } else if (arg == "--top" && i + 1 < argc) {
+        options.top = std::stoul(argv[++i]);
+      } else if (arg == "--disassembly") {
+        options.disassembly = true;
+      } else if (!arg.starts_with("--")) {
+        options.roms.emplace_back(arg);
+      } else {
+        return std::nullopt;
+      }
+    }
+  } catch (std::exception const &) {
+    return std::nullopt;
+  }
+
+  if (options.roms.empty()) {
+    return std::nullopt;
+  }
+
+  return options;
+}
+
+std::string quote(std::string_view text) {
+  std::string result = "\"";
+  for (auto c : text) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    } else if (uint8_t(c) < 0x20) {
+      result += "\\u00" + hex(uint8_t(c), 2);
+    } else {
+      result += c;
+    }
+  }
+
+  return result + "\"";
+}
+
+void write_counts(std::ostream &ostream,
+                  std::map<std::string, size_t> const &counts, size_t top) {
+  std::vector<std::pair<std::string, size_t>> sorted(counts.begin(),
+                                                     counts.end());
+  std::ranges::stable_sort(sorted, std::greater{},
+                           &std::pair<std::string, size_t>::second);
+  if (top && sorted.size() > top) {
+    sorted.resize(top);
+  }
+
+  ostream << '{';
+  for (size_t i = 0; i < sorted.size(); i++) {
+    ostream << (i ? ", " : "") << quote(sorted[i].first) << ": "
+            << sorted[i].second;
+  }
+  ostream << '}';
+}
+
+void write_sites(std::ostream &ostream, std::vector<Site> const &sites) {
+  ostream << '[';
+  for (size_t i = 0; i < sites.size(); i++) {
+    ostream << (i ? ", " : "") << "{\"location\": \"0x"
+            << hex(sites[i].location, 3) << "\", \"opcode\": \""
+            << hex(sites[i].opcode, 4) << "\"}";
+  }
+  ostream << ']';
+}
+
+void write_disassembly(std::ostream &ostream, Analysis const &analysis,
+                       std::vector<uint8_t> const &program) {
+  Cpu cpu{program};
+
+  ostream << '[';
+  bool first = true;
+  for (size_t location = 0; location < Cpu::MEMORY_SIZE; location++) {
+    auto word = cpu.fetch<uint16_t>(location);
+    if (!analysis.reachable[location] || !word) {
+      continue;
+    }
+
+    ostream << (first ? "" : ", ") << "{\"location\": \"0x"
+            << hex(location, 3) << "\", \"opcode\": \"" << hex(*word, 4)
+            << "\", \"text\": "
+            << quote(disassemble(Opcode{*word}).value_or("???")) << '}';
+    first = false;
+  }
+  ostream << ']';
+}
+
+Report analyse_rom(std::filesystem::path const &path, Options const &options) {
+  std::ostringstream json;
+  json << "    {\"path\": " << quote(path.string());
+
+  auto program = read_program(path);
+  if (!program) {
+    json << ", \"error\": \"not a loadable ROM\"}";
+    return {json.str(), std::nullopt};
+  }
+
+  auto analysis = analyse(*program, options.ngram);
+
+  size_t instructions = 0;
+  for (auto &&[pattern, count] : analysis.opcodes) {
+    instructions += count;
+  }
+
+  json << ", \"size\": " << program->size()
+       << ", \"instructions\": " << instructions << ",\n     \"opcodes\": ";
+  write_counts(json, analysis.opcodes, 0);
+  json << ",\n     \"ngrams\": ";
+  write_counts(json, analysis.ngrams, options.top);
+  json << ",\n     \"illegal\": ";
+  write_sites(json, analysis.illegal);
+  json << ",\n     \"indirect_jumps\": ";
+  write_sites(json, analysis.indirect_jumps);
+
+  json << ",\n     \"self_modifying\": [";
+  for (size_t i = 0; i < analysis.writes.size(); i++) {
+    auto &&write = analysis.writes[i];
+    json << (i ? ", " : "") << "{\"location\": \"0x"
+         << hex(write.location, 3) << "\", \"opcode\": \""
+         << hex(write.opcode, 4) << "\", \"target\": "
+         << (write.target ? "\"0x" + hex(*write.target, 3) + "\"" : "null")
+         << ", \"overwrites_code\": "
+         << (write.overwrites_code ? "true" : "false") << '}';
+  }
+
+  json << "],\n     \"quirks\": [";
+  for (size_t i = 0; i < analysis.quirks.size(); i++) {
+    json << (i ? ", " : "") << quote(analysis.quirks[i]);
+  }
+  json << ']';
+
+  if (options.disassembly) {
+    json << ",\n     \"disassembly\": ";
+    write_disassembly(json, analysis, *program);
+  }
+  json << '}';
+
+  return {json.str(), std::move(analysis)};
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  auto options = parse(argc, argv);
+  if (!options) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto roms = corpus(options->roms);
+  std::vector<Report> reports(roms.size());
+  parallel_for(roms.size(),
+               [&](size_t i) { reports[i] = analyse_rom(roms[i], *options); });
+
+  size_t analysed = 0;
+  std::map<std::string, size_t> opcodes, ngrams, quirks;
+  for (auto &&report : reports) {
+    if (!report.analysis) {
+      continue;
+    }
+
+    analysed++;
+    for (auto &&[pattern, count] : report.analysis->opcodes) {
+      opcodes[pattern] += count;
+    }
+    for (auto &&[ngram, count] : report.analysis->ngrams) {
+      ngrams[ngram] += count;
+    }
+    for (auto &&quirk : report.analysis->quirks) {
+      quirks[quirk]++;
+    }
+  }
+
+  std::cout << "{\n  \"roms\": [\n";
+  for (size_t i = 0; i < reports.size(); i++) {
+    std::cout << reports[i].json << (i + 1 < reports.size() ? ",\n" : "\n");
+  }
+
+  std::cout << "  ],\n  \"aggregate\": {\"roms\": " << analysed
+            << ", \"failed\": " << reports.size() - analysed
+            << ",\n    \"opcodes\": ";
+  write_counts(std::cout, opcodes, 0);
+  std::cout << ",\n    \"ngrams\": ";
+  write_counts(std::cout, ngrams, options->top);
+  std::cout << ",\n    \"quirks\": ";
+  write_counts(std::cout, quirks, 0);
+  std::cout << "}\n}\n";
+
+  return analysed == reports.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
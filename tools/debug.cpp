@@ -0,0 +1,126 @@
+#include "debugger.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+using namespace chip_8;
+
+namespace {
+size_t constexpr CONTINUE_FRAMES = 600;
+size_t constexpr MEMORY_SIZE = 0x40;
+
+void usage(char const *name) { std::cerr << "usage: " << name << " <rom>\n"; }
+
+void help() {
+  std::cout << "b ADDR      set breakpoint\n"
+               "db ADDR     delete breakpoint\n"
+               "w ADDR      set watchpoint\n"
+               "dw ADDR     delete watchpoint\n"
+               "s           step\n"
+               "n           step over\n"
+               "c [FRAMES]  continue\n"
+               "r           registers\n"
+               "x ADDR [N]  memory\n"
+               "k KEY       press key\n"
+               "u KEY       release key\n"
+               "q           quit\n";
+}
+
+uint16_t number(std::istream &istream) {
+  std::string word;
+  istream >> word;
+  return std::stoul(word, nullptr, 0);
+}
+
+void run(Emulator &emulator, Debugger &debugger, size_t frames) {
+  debugger.resume();
+  for (size_t frame = 0; frame < frames && debugger.running(); frame++) {
+    emulator.run_frame();
+  }
+}
+
+bool execute(std::string const &line, Emulator &emulator,
+             Debugger &debugger) {
+  std::istringstream istream{line};
+  std::string command;
+  if (!(istream >> command)) {
+    return true;
+  }
+
+  auto &&cpu = emulator.cpu;
+
+  if (command == "b") {
+    debugger.add_breakpoint(number(istream));
+  } else if (command == "db") {
+    debugger.remove_breakpoint(number(istream));
+  } else if (command == "w") {
+    debugger.add_watchpoint(number(istream));
+  } else if (command == "dw") {
+    debugger.remove_watchpoint(number(istream));
+  } else if (command == "s") {
+    debugger.step();
+    debugger.write_location(std::cout);
+  } else if (command == "n") {
+    debugger.step_over();
+    debugger.write_location(std::cout);
+  } else if (command == "c") {
+    size_t frames = CONTINUE_FRAMES;
+    istream >> frames;
+    run(emulator, debugger, frames);
+    debugger.pause();
+    debugger.write_location(std::cout);
+  } else if (command == "r") {
+    debugger.write_registers(std::cout);
+  } else if (command == "x") {
+    auto location = number(istream);
+    size_t size = MEMORY_SIZE;
+    istream >> size;
+    debugger.write_memory(std::cout, location, size);
+  } else if (command == "k" || command == "u") {
+    auto key = number(istream);
+    if (key < cpu.keyboard.size()) {
+      cpu.keyboard[key] = command == "k";
+    }
+  } else if (command == "q") {
+    return false;
+  } else {
+    help();
+  }
+
+  return true;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto program = read_program(argv[1]);
+  if (!program) {
+    std::cerr << argv[1] << ": not a loadable ROM\n";
+    return EXIT_FAILURE;
+  }
+
+  Emulator emulator{std::move(*program)};
+  Debugger debugger{emulator};
+  debugger.pause();
+  debugger.write_location(std::cout);
+
+  for (std::string line; std::cout << "> " << std::flush,
+                         std::getline(std::cin, line);) {
+    try {
+      if (!execute(line, emulator, debugger)) {
+        break;
+      }
+    } catch (std::exception const &) {
+      std::cout << "invalid argument\n";
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,359 @@
+#include "emulator.hpp"
+#include "parallel.hpp"
+
+#include <bitset>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using namespace chip_8;
+
+namespace {
+struct Options {
+  std::filesystem::path rom;
+  std::filesystem::path crashes;
+  std::filesystem::path replay;
+  size_t warmup = 60;
+  size_t frames = 10;
+  size_t iterations = 1'000'000;
+  size_t mutations = 4;
+  uint64_t seed = 1;
+};
+
+struct Mutation {
+  uint16_t location;
+  uint8_t value;
+};
+
+struct Input {
+  std::array<Mutation, 0x20> mutations;
+  size_t size = 0;
+  uint16_t keys = 0;
+};
+
+struct Crash {
+  size_t warmup;
+  size_t frames;
+  Input input;
+};
+
+struct Site {
+  Trap trap;
+  uint16_t location;
+
+  auto operator<=>(Site const &) const = default;
+};
+
+struct Report {
+  std::bitset<0x1000> locations;
+  std::bitset<0x10000> opcodes;
+  std::map<Trap, size_t> traps;
+  std::map<Site, Input> sites;
+  size_t executions = 0;
+};
+
+class Random {
+public:
+  explicit Random(uint64_t seed) noexcept : _state(seed | 1) {}
+
+  uint64_t operator()() noexcept {
+    _state ^= _state << 13;
+    _state ^= _state >> 7;
+    _state ^= _state << 17;
+    return _state;
+  }
+
+private:
+  uint64_t _state;
+};
+
+std::string_view name(Trap trap) {
+  switch (trap) {
+  case Trap::STACK_OVERFLOW:
+    return "stack overflow";
+  case Trap::STACK_UNDERFLOW:
+    return "stack underflow";
+  case Trap::OUT_OF_BOUNDS:
+    return "out of bounds";
+  case Trap::BREAKPOINT:
+    return "breakpoint";
+  case Trap::WATCHPOINT:
+    return "watchpoint";
+  default:
+    return "none";
+  }
+}
+
+void usage(char const *name) {
+  std::cerr << "usage: " << name
+            << " [--warmup FRAMES] [--frames N] [--iterations N]"
+               " [--mutations N] [--seed N] [--crashes DIR] <rom>\n"
+            << "       " << name << " --replay CRASH <rom>\n";
+}
+
+std::optional<Options> parse(int argc, char *argv[]) {
+  Options options;
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string_view arg = argv[i];
+
+      if (arg == "--warmup" && i + 1 < argc) {
+        options.warmup = std::stoul(argv[++i]);
+      } else if (arg == "--frames" && i + 1 < argc) {
+        options.frames = std::stoul(argv[++i]);
+      } else if (arg == "--iterations" && i + 1 < argc) {
+        options.iterations = std::stoul(argv[++i]);
+      } else if (arg == "--mutations" && i + 1 < argc) {
+        options.mutations = std::stoul(argv[++i]);
+      } else if (arg == "--seed" && i + 1 < argc) {
+        options.seed = std::stoull(argv[++i]);
+      } else if (arg == "--crashes" && i + 1 < argc) {
+        options.crashes = argv[++i];
+      } else if (arg == "--replay" && i + 1 < argc) {
+        options.replay = argv[++i];
+      } else if (options.rom.empty() && !arg.starts_with("--")) {
+        options.rom = arg;
+      } else {
+        return std::nullopt;
+      }
+    }
+  } catch (std::exception const &) {
+    return std::nullopt;
+  }
+
+  if (options.rom.empty() || options.mutations == 0 ||
+      options.mutations > Input{}.mutations.size()) {
+    return std::nullopt;
+  }
+
+  return options;
+}
+
+void mutate(Input &input, Random &random, size_t mutations) {
+  for (auto count = random() % mutations + 1; count; count--) {
+    Mutation mutation{uint16_t(0x200 + random() % Cpu::PROGRAM_SIZE),
+                      uint8_t(random())};
+
+    if (input.size < input.mutations.size() && random() % 2) {
+      input.mutations[input.size++] = mutation;
+    } else if (input.size) {
+      input.mutations[random() % input.size] = mutation;
+    }
+  }
+
+  if (random() % 4 == 0) {
+    input.keys ^= 1 << random() % 0x10;
+  }
+}
+
+void apply(Cpu &cpu, Input const &input) noexcept {
+  for (size_t i = 0; i < input.size; i++) {
+    cpu.write(input.mutations[i].location, input.mutations[i].value);
+  }
+  for (size_t key = 0; key < cpu.keyboard.size(); key++) {
+    cpu.keyboard[key] = input.keys >> key & 1;
+  }
+}
+
+Report fuzz(Cpu const &snapshot, Options const &options, size_t iterations,
+            uint64_t seed) {
+  Report report;
+  Random random{seed};
+  std::vector<Input> corpus(1);
+  size_t static constexpr CORPUS_SIZE = 0x1000;
+
+  Emulator emulator;
+  auto &&cpu = emulator.cpu;
+
+  for (size_t iteration = 0; iteration < iterations; iteration++) {
+    auto input = corpus[random() % corpus.size()];
+    mutate(input, random, options.mutations);
+
+    cpu = snapshot;
+    apply(cpu, input);
+
+    bool discovered = false;
+    for (auto end = emulator.frames + options.frames; emulator.frames < end;) {
+      auto location = cpu.program_counter;
+      if (auto opcode = cpu.fetch<uint16_t>(location)) {
+        discovered |= !report.locations[location];
+        discovered |= !report.opcodes[*opcode];
+        report.locations.set(location);
+        report.opcodes.set(*opcode);
+      }
+
+      emulator.step();
+      if (cpu.trap != Trap::NONE) {
+        report.traps[cpu.trap]++;
+        report.sites.try_emplace({cpu.trap, location}, input);
+        break;
+      }
+    }
+
+    if (discovered && corpus.size() < CORPUS_SIZE) {
+      corpus.push_back(input);
+    }
+  }
+
+  report.executions = iterations;
+  return report;
+}
+
+void write_crash(std::filesystem::path const &directory, Site const &site,
+                 Crash const &crash) {
+  std::ostringstream name;
+  name << "crash-" << int(site.trap) << "-" << std::hex << site.location
+       << ".txt";
+
+  std::ofstream ofstream{directory / name.str()};
+  ofstream << "warmup " << crash.warmup << "\nframes " << crash.frames
+           << "\n" << std::hex << "keys " << crash.input.keys << "\n";
+  for (size_t i = 0; i < crash.input.size; i++) {
+    ofstream << crash.input.mutations[i].location << " "
+             << +crash.input.mutations[i].value << "\n";
+  }
+}
+
+std::optional<Crash> read_crash(std::filesystem::path const &path) {
+  std::ifstream ifstream{path};
+  if (!ifstream) {
+    return std::nullopt;
+  }
+
+  Crash crash{0, 0, {}};
+  for (std::string line; std::getline(ifstream, line);) {
+    std::istringstream istringstream{line};
+    std::string field;
+    if (!(istringstream >> field)) {
+      continue;
+    }
+
+    if (field == "warmup") {
+      istringstream >> std::dec >> crash.warmup;
+    } else if (field == "frames") {
+      istringstream >> std::dec >> crash.frames;
+    } else if (field == "keys") {
+      istringstream >> std::hex >> crash.input.keys;
+    } else {
+      size_t location = 0, value = 0;
+      istringstream.str(line);
+      istringstream.clear();
+      istringstream >> std::hex >> location >> value;
+      if (crash.input.size == crash.input.mutations.size() ||
+          location >= Cpu::MEMORY_SIZE || value > 0xFF) {
+        return std::nullopt;
+      }
+      crash.input.mutations[crash.input.size++] = {uint16_t(location),
+                                                   uint8_t(value)};
+    }
+
+    if (istringstream.fail()) {
+      return std::nullopt;
+    }
+  }
+
+  return crash;
+}
+
+int replay(Emulator &emulator, Crash const &crash) {
+  for (size_t frame = 0; frame < crash.warmup; frame++) {
+    emulator.run_frame();
+  }
+  apply(emulator.cpu, crash.input);
+
+  for (auto end = emulator.frames + crash.frames; emulator.frames < end;) {
+    auto location = emulator.cpu.program_counter;
+    emulator.step();
+    if (emulator.cpu.trap != Trap::NONE) {
+      std::cout << name(emulator.cpu.trap) << " at 0x" << std::hex
+                << location << std::dec << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "no trap in " << crash.frames << " frames\n";
+  return EXIT_SUCCESS;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  auto options = parse(argc, argv);
+  if (!options) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto program = read_program(options->rom);
+  if (!program) {
+    std::cerr << options->rom.string() << ": not a loadable ROM\n";
+    return EXIT_FAILURE;
+  }
+
+  Emulator emulator{std::move(*program)};
+  if (!options->replay.empty()) {
+    auto crash = read_crash(options->replay);
+    if (!crash) {
+      std::cerr << options->replay.string() << ": not a crash file\n";
+      return EXIT_FAILURE;
+    }
+    return replay(emulator, *crash);
+  }
+
+  for (size_t frame = 0; frame < options->warmup; frame++) {
+    emulator.run_frame();
+  }
+  auto snapshot = emulator.cpu;
+
+  auto workers = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<Report> reports(workers);
+
+  auto start = std::chrono::steady_clock::now();
+  parallel_for(workers, [&](size_t worker) {
+    auto iterations = options->iterations / workers +
+                      (worker < options->iterations % workers);
+    reports[worker] = fuzz(snapshot, *options, iterations,
+                           options->seed + worker);
+  });
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  Report total;
+  for (auto &&report : reports) {
+    total.locations |= report.locations;
+    total.opcodes |= report.opcodes;
+    total.executions += report.executions;
+    for (auto [trap, count] : report.traps) {
+      total.traps[trap] += count;
+    }
+    total.sites.merge(report.sites);
+  }
+
+  std::cout << total.executions << " executions in " << elapsed.count()
+            << " s (" << size_t(total.executions / elapsed.count())
+            << " executions/s)\n"
+            << total.locations.count() << " locations, "
+            << total.opcodes.count() << " opcodes covered\n";
+
+  for (auto [trap, count] : total.traps) {
+    std::cout << count << " x " << name(trap) << "\n";
+  }
+  for (auto &&[site, input] : total.sites) {
+    std::cout << name(site.trap) << " at 0x" << std::hex << site.location
+              << std::dec << "\n";
+
+    if (!options->crashes.empty()) {
+      write_crash(options->crashes, site,
+                  {options->warmup, options->frames, input});
+    }
+  }
+
+  return total.sites.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,197 @@
+#include "capture.hpp"
+#include "emulator.hpp"
+#include "metrics.hpp"
+#include "shared_frames.hpp"
+#include "speed_meter.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace chip_8;
+
+namespace {
+struct Options {
+  std::filesystem::path rom;
+  size_t frames = 600;
+  double speed = 1;
+  Timing timing = Timing::fixed();
+  std::filesystem::path capture;
+  std::filesystem::path metrics_file;
+  std::filesystem::path metrics_socket;
+
+  std::string shm;
+  size_t slot = 0;
+  size_t slots = 1;
+  bool unlink = false;
+};
+
+void usage(char const *name) {
+  std::cerr << "usage: " << name
+            << " [--frames N] [--speed MULTIPLIER|uncapped]"
+               " [--timing fixed|vip] [--capture PREFIX]"
+               " [--metrics-file PATH] [--metrics-socket PATH]"
+               " [--shm NAME [--slot K] [--slots N] [--unlink]] <rom>\n";
+}
+
+std::optional<Options> parse(int argc, char *argv[]) {
+  Options options;
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string_view arg = argv[i];
+
+      if (arg == "--frames" && i + 1 < argc) {
+        options.frames = std::stoul(argv[++i]);
+      } else if (arg == "--speed" && i + 1 < argc) {
+        std::string_view speed = argv[++i];
+        options.speed = speed == "uncapped" ? 0 : std::stod(argv[i]);
+      } else if (arg == "--timing" && i + 1 < argc) {
+        auto timing = parse_timing(argv[++i]);
+        if (!timing) {
+          return std::nullopt;
+        }
+        options.timing = *timing;
+      } else if (arg == "--capture" && i + 1 < argc) {
+        options.capture = argv[++i];
+      } else if (arg == "--metrics-file" && i + 1 < argc) {
+        options.metrics_file = argv[++i];
+      } else if (arg == "--metrics-socket" && i + 1 < argc) {
+        options.metrics_socket = argv[++i];
+      } else if (arg == "--shm" && i + 1 < argc) {
+        options.shm = argv[++i];
+      } else if (arg == "--slot" && i + 1 < argc) {
+        options.slot = std::stoul(argv[++i]);
+      } else if (arg == "--slots" && i + 1 < argc) {
+        options.slots = std::stoul(argv[++i]);
+      } else if (arg == "--unlink") {
+        options.unlink = true;
+      } else if (options.rom.empty() && !arg.starts_with("--")) {
+        options.rom = arg;
+      } else {
+        return std::nullopt;
+      }
+    }
+  } catch (std::exception const &) {
+    return std::nullopt;
+  }
+
+  if (options.rom.empty() || options.speed < 0 ||
+      options.slot >= options.slots) {
+    return std::nullopt;
+  }
+
+  return options;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  auto options = parse(argc, argv);
+  if (!options) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto program = read_program(options->rom);
+  if (!program) {
+    std::cerr << options->rom.string() << ": not a loadable ROM\n";
+    return EXIT_FAILURE;
+  }
+
+  Emulator emulator{std::move(*program)};
+  emulator.set_timing(options->timing);
+
+  std::optional<SharedFrames> shared_frames;
+  if (!options->shm.empty()) {
+    shared_frames = SharedFrames::create(options->shm, options->slots);
+    if (!shared_frames) {
+      std::cerr << options->shm << ": cannot map shared memory with "
+                << options->slots << " slots\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::unique_ptr<Capture> capture;
+  if (!options->capture.empty()) {
+    capture = Capture::open(options->capture);
+    if (!capture) {
+      std::cerr << options->capture.string() << ": cannot open capture\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  Metrics metrics;
+  EmulatorMetrics emulator_metrics{metrics};
+
+  std::unique_ptr<MetricsServer> metrics_server;
+  if (!options->metrics_socket.empty()) {
+    metrics_server = MetricsServer::open(options->metrics_socket, metrics);
+    if (!metrics_server) {
+      std::cerr << options->metrics_socket.string()
+                << ": cannot listen for metrics\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  using Clock = SpeedMeter::Clock;
+  auto constexpr METRICS_INTERVAL = std::chrono::seconds{1};
+  auto metrics_written = Clock::now();
+
+  std::chrono::duration<double> frame_time{
+      options->speed ? 1 / (SpeedMeter::FRAMES_PER_SECOND * options->speed)
+                     : 0};
+
+  auto start = Clock::now();
+  for (size_t frame = 0; frame < options->frames; frame++) {
+    auto frame_start = Clock::now();
+    emulator.run_frame();
+
+    auto now = Clock::now();
+    emulator_metrics.frame_time.observe(now - frame_start);
+    emulator_metrics.record(emulator);
+    if (!options->metrics_file.empty() &&
+        now - metrics_written >= METRICS_INTERVAL) {
+      metrics.write_textfile(options->metrics_file);
+      metrics_written = now;
+    }
+
+    if (shared_frames) {
+      shared_frames->publish(options->slot, emulator.cpu, frame);
+    }
+
+    if (capture) {
+      capture->push(emulator.cpu, frame);
+    }
+
+    if (options->speed) {
+      std::this_thread::sleep_until(
+          start + std::chrono::duration_cast<Clock::duration>(frame_time *
+                                                              (frame + 1)));
+    }
+  }
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+
+  std::cout << options->frames << " frames in " << elapsed.count() << " s ("
+            << options->frames / elapsed.count() /
+                   SpeedMeter::FRAMES_PER_SECOND
+            << "x)\n";
+
+  if (!options->metrics_file.empty() &&
+      !metrics.write_textfile(options->metrics_file)) {
+    std::cerr << options->metrics_file.string() << ": cannot write metrics\n";
+  }
+
+  if (capture) {
+    auto dropped = capture->dropped();
+    capture.reset();
+    std::cout << dropped << " captured frames dropped\n";
+  }
+
+  if (shared_frames && options->unlink) {
+    SharedFrames::unlink(options->shm);
+  }
+
+  return EXIT_SUCCESS;
+}
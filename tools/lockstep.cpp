@@ -0,0 +1,177 @@
+#include "disassembler.hpp"
+#include "emulator.hpp"
+#include "lockstep.hpp"
+#include "parallel.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using namespace chip_8;
+
+namespace {
+enum class Status : uint8_t { SKIPPED, PASSED, FAILED };
+
+struct Options {
+  std::vector<std::filesystem::path> roms;
+  LockstepOptions lockstep;
+};
+
+void usage(char const *name) {
+  std::cerr << "usage: " << name
+            << " [--steps N] [--interval N] [--hold N] [--seed N]"
+               " [--timing fixed|vip] <rom|directory>...\n";
+}
+
+std::optional<Options> parse(int argc, char *argv[]) {
+  Options options;
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string_view arg = argv[i];
+
+      if (arg == "--steps" && i + 1 < argc) {
+        options.lockstep.steps = std::stoull(argv[++i]);
+      } else if (arg == "--interval" && i + 1 < argc) {
+        options.lockstep.interval = std::stoull(argv[++i]);
+      } else if (arg == "--hold" && i + 1 < argc) {
+        options.lockstep.hold = std::stoull(argv[++i]);
+      } else if (arg == "--seed" && i + 1 < argc) {
+        options.lockstep.seed = std::stoull(argv[++i]);
+      } else if (arg == "--timing" && i + 1 < argc) {
+        auto timing = parse_timing(argv[++i]);
+        if (!timing) {
+          return std::nullopt;
+        }
+        options.lockstep.timing = *timing;
+      } else if (!arg.starts_with("--")) {
+        options.roms.emplace_back(arg);
+      } else {
+        return std::nullopt;
+      }
+    }
+  } catch (std::exception const &) {
+    return std::nullopt;
+  }
+
+  if (options.roms.empty() || options.lockstep.interval == 0 ||
+      options.lockstep.hold == 0) {
+    return std::nullopt;
+  }
+
+  return options;
+}
+
+void write_cpu(std::ostream &ostream, std::string_view name, Cpu const &cpu) {
+  ostream << "  " << name << ": PC=0x" << hex(cpu.program_counter, 3)
+          << " I=0x" << hex(cpu.index, 3) << " SP=" << +cpu.stack_pointer
+          << " DT=" << +cpu.timers[std::to_underlying(Timer::DELAY)]
+          << " ST=" << +cpu.timers[std::to_underlying(Timer::SOUND)]
+          << " cycles=" << cpu.cycles << " trap="
+          << +std::to_underlying(cpu.trap);
+  if (cpu.key_wait) {
+    ostream << " wait=V" << hex(*cpu.key_wait, 1);
+  }
+  ostream << "\n   ";
+
+  for (auto [n, value] : cpu.registers | std::views::enumerate) {
+    ostream << " V" << hex(n, 1) << '=' << hex(value, 2);
+  }
+  for (uint8_t n = 0; n < cpu.stack_pointer; n++) {
+    ostream << (n ? " " : "\n    stack: 0x") << hex(cpu.stack[n], 3);
+  }
+  ostream << '\n';
+}
+
+void write_divergence(std::ostream &ostream, Divergence const &divergence) {
+  auto &&before = divergence.before;
+  auto &&reference = divergence.reference;
+  auto &&candidate = divergence.candidate;
+
+  ostream << "  first differing step " << divergence.step << " at 0x"
+          << hex(before.program_counter, 3);
+  if (auto word = before.fetch<uint16_t>(before.program_counter)) {
+    ostream << "  " << hex(*word, 4);
+    ostream << "  " << disassemble(Opcode{*word}).value_or("???");
+  }
+  ostream << '\n';
+
+  write_cpu(ostream, "before", before);
+  write_cpu(ostream, "reference", reference);
+  write_cpu(ostream, "candidate", candidate);
+
+  for (size_t i = 0; i < Cpu::MEMORY_SIZE; i++) {
+    if (reference.memory[i] != candidate.memory[i]) {
+      ostream << "  memory 0x" << hex(i, 3) << ": "
+              << hex(reference.memory[i], 2) << " != "
+              << hex(candidate.memory[i], 2) << '\n';
+    }
+  }
+
+  auto reference_rows = reference.screen.rows();
+  auto candidate_rows = candidate.screen.rows();
+  for (size_t y = 0; y < Screen::HEIGHT; y++) {
+    if (reference_rows[y] != candidate_rows[y]) {
+      ostream << "  screen row " << y << " differs\n";
+    }
+  }
+  if (reference.keyboard != candidate.keyboard) {
+    ostream << "  keyboard state differs\n";
+  }
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  auto options = parse(argc, argv);
+  if (!options) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto roms = corpus(options->roms);
+  std::vector<std::string> reports(roms.size());
+  std::vector<Status> statuses(roms.size(), Status::SKIPPED);
+
+  parallel_for(roms.size(), [&](size_t i) {
+    std::ostringstream report;
+    auto program = read_program(roms[i]);
+    if (!program) {
+      report << "SKIP " << roms[i].string() << ": not a loadable ROM\n";
+      reports[i] = report.str();
+      return;
+    }
+
+    auto result = lockstep(Cpu{*program}, options->lockstep);
+    if (result.divergence) {
+      report << "FAIL " << roms[i].string() << '\n';
+      write_divergence(report, *result.divergence);
+      statuses[i] = Status::FAILED;
+    } else {
+      report << "PASS " << roms[i].string() << " (" << result.steps
+             << " steps)\n";
+      statuses[i] = Status::PASSED;
+    }
+    reports[i] = report.str();
+  });
+
+  for (auto &&report : reports) {
+    std::cout << report;
+  }
+
+  // Unloadable files are reported but do not count as checked ROMs
+  auto passed = std::ranges::count(statuses, Status::PASSED);
+  auto failures = std::ranges::count(statuses, Status::FAILED);
+  auto skipped = std::ranges::count(statuses, Status::SKIPPED);
+  std::cout << passed << "/" << passed + failures << " passed";
+  if (skipped) {
+    std::cout << ", " << skipped << " skipped";
+  }
+  std::cout << "\n";
+
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,231 @@
+#include "emulator.hpp"
+#include "hash.hpp"
+#include "parallel.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+using namespace chip_8;
+
+namespace {
+struct Event {
+  size_t frame;
+  uint8_t key;
+  bool pressed;
+};
+
+struct Case {
+  std::string name;
+  std::filesystem::path path;
+  size_t frames;
+  size_t interval;
+  double min_ips;
+  std::vector<Event> events;
+};
+
+struct Checkpoint {
+  size_t frame;
+  uint64_t screen;
+  uint64_t cpu;
+
+  bool operator==(Checkpoint const &) const = default;
+};
+
+struct Result {
+  std::vector<Checkpoint> checkpoints;
+  double ips = 0;
+  bool loaded = false;
+};
+
+std::optional<std::vector<Event>> parse_events(std::string_view script) {
+  std::vector<Event> events;
+  std::istringstream istringstream{std::string{script}};
+
+  for (std::string token; std::getline(istringstream, token, ',');) {
+    auto colon = token.find(':');
+    if (colon == std::string::npos || colon + 1 >= token.size() ||
+        (token[colon + 1] != '+' && token[colon + 1] != '-')) {
+      return std::nullopt;
+    }
+
+    try {
+      events.push_back({std::stoul(token.substr(0, colon)),
+                        uint8_t(std::stoul(token.substr(colon + 2), nullptr,
+                                           16) & 0xF),
+                        token[colon + 1] == '+'});
+    } catch (std::exception const &) {
+      return std::nullopt;
+    }
+  }
+
+  std::ranges::stable_sort(events, {}, &Event::frame);
+  return events;
+}
+
+std::optional<std::vector<Case>> read_manifest(
+    std::filesystem::path const &path) {
+  std::ifstream ifstream{path};
+  if (!ifstream) {
+    return std::nullopt;
+  }
+
+  std::vector<Case> cases;
+  for (std::string line; std::getline(ifstream, line);) {
+    if (line.empty() || line.starts_with('#')) {
+      continue;
+    }
+
+    Case test_case;
+    std::string script;
+    std::istringstream istringstream{line};
+    istringstream >> test_case.name >> test_case.frames >> test_case.interval >>
+        test_case.min_ips;
+    bool parsed = istringstream && test_case.interval && test_case.min_ips >= 0;
+
+    // Only the event script may be left out
+    std::string extra;
+    istringstream >> script;
+    auto events = parse_events(script);
+    if (!parsed || !events || istringstream >> extra) {
+      std::cerr << path.string() << ": malformed line: " << line << "\n";
+      return std::nullopt;
+    }
+
+    test_case.path = path.parent_path() / test_case.name;
+    test_case.events = std::move(*events);
+    cases.push_back(std::move(test_case));
+  }
+
+  return cases;
+}
+
+std::map<std::string, std::vector<Checkpoint>> read_golden(
+    std::filesystem::path const &path) {
+  std::map<std::string, std::vector<Checkpoint>> golden;
+  std::ifstream ifstream{path};
+
+  std::string name;
+  Checkpoint checkpoint;
+  while (ifstream >> name >> std::dec >> checkpoint.frame >> std::hex >>
+         checkpoint.screen >> checkpoint.cpu) {
+    golden[name].push_back(checkpoint);
+  }
+
+  return golden;
+}
+
+Result run(Case const &test_case) {
+  Result result;
+
+  auto program = read_program(test_case.path);
+  if (!program) {
+    return result;
+  }
+  result.loaded = true;
+
+  Emulator emulator{std::move(*program)};
+  auto event = test_case.events.begin();
+
+  auto instructions = emulator.instructions;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t frame = 0; frame < test_case.frames; frame++) {
+    for (; event != test_case.events.end() && event->frame == frame; event++) {
+      emulator.cpu.keyboard[event->key] = event->pressed;
+    }
+
+    emulator.run_frame();
+
+    if ((frame + 1) % test_case.interval == 0) {
+      result.checkpoints.push_back(
+          {frame + 1, hash(emulator.cpu.screen), hash(emulator.cpu)});
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  instructions = emulator.instructions - instructions;
+  result.ips = instructions / std::max(elapsed.count(), 1e-9);
+
+  return result;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::vector<std::string_view> args(argv + 1, argv + argc);
+  bool update = std::erase(args, "--update") > 0;
+
+  if (args.size() != 2) {
+    std::cerr << "usage: " << argv[0] << " [--update] <manifest> <golden>\n"
+              << "manifest lines: <rom> <frames> <checkpoint interval> "
+                 "<min instructions/s> [<frame>:+<key>,<frame>:-<key>,...]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::filesystem::path manifest_path{args[0]}, golden_path{args[1]};
+  auto cases = read_manifest(manifest_path);
+  if (!cases) {
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Result> results(cases->size());
+  parallel_for(cases->size(),
+               [&](size_t i) { results[i] = run((*cases)[i]); });
+
+  if (update) {
+    std::ofstream ofstream{golden_path};
+    ofstream << std::hex << std::setfill('0');
+    for (size_t i = 0; i < cases->size(); i++) {
+      for (auto &&checkpoint : results[i].checkpoints) {
+        ofstream << (*cases)[i].name << " " << std::dec << checkpoint.frame
+                 << " " << std::hex << std::setw(16) << checkpoint.screen
+                 << " " << std::setw(16) << checkpoint.cpu << "\n";
+      }
+    }
+
+    return ofstream.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  auto golden = read_golden(golden_path);
+
+  size_t failures = 0;
+  for (size_t i = 0; i < cases->size(); i++) {
+    auto &&test_case = (*cases)[i];
+    auto &&result = results[i];
+
+    std::string error;
+    if (!result.loaded) {
+      error = "cannot read " + test_case.path.string();
+    } else if (result.checkpoints != golden[test_case.name]) {
+      auto &&expected = golden[test_case.name];
+      auto [actual_it, expected_it] =
+          std::ranges::mismatch(result.checkpoints, expected);
+      auto frame = actual_it != result.checkpoints.end() ? actual_it->frame
+                   : expected_it != expected.end()       ? expected_it->frame
+                                                         : 0;
+      error = "state differs from golden at frame " + std::to_string(frame);
+    } else if (result.ips < test_case.min_ips) {
+      error = "too slow: " + std::to_string(size_t(result.ips)) +
+              " instructions/s";
+    }
+
+    if (error.empty()) {
+      std::cout << "PASS " << test_case.name << " ("
+                << size_t(result.ips) << " instructions/s)\n";
+    } else {
+      std::cout << "FAIL " << test_case.name << ": " << error << "\n";
+      failures++;
+    }
+  }
+
+  std::cout << cases->size() - failures << "/" << cases->size()
+            << " passed\n";
+
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,39 @@
+#include "remote.hpp"
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+using namespace chip_8;
+
+namespace {
+int constexpr POLL_TIMEOUT = 100;
+
+volatile std::sig_atomic_t stopping = 0;
+
+void stop(int) { stopping = 1; }
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    std::cerr << "usage: " << argv[0] << " <socket>\n"
+              << "commands: new | load ID PATH | press ID KEY | release ID KEY"
+                 " | step ID [FRAMES] | watch ID | unwatch ID | snapshot ID"
+                 " | restore ID SLOT | state ID | quit\n";
+    return EXIT_FAILURE;
+  }
+
+  auto server = RemoteServer::open(argv[1]);
+  if (!server) {
+    std::cerr << argv[1] << ": cannot listen\n";
+    return EXIT_FAILURE;
+  }
+
+  std::signal(SIGINT, stop);
+  std::signal(SIGTERM, stop);
+  while (!stopping) {
+    server->poll(POLL_TIMEOUT);
+  }
+
+  return EXIT_SUCCESS;
+}
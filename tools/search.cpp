@@ -0,0 +1,164 @@
+#include "emulator.hpp"
+#include "search.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+using namespace chip_8;
+
+namespace {
+struct Goal {
+  bool register_goal = false;
+  size_t location = 0;
+  uint8_t value = 0;
+
+  bool operator()(Cpu const &cpu) const noexcept {
+    return (register_goal ? cpu.registers[location] : cpu.memory[location]) ==
+           value;
+  }
+};
+
+struct Options {
+  std::filesystem::path rom;
+  SearchOptions search;
+  std::optional<Goal> goal;
+};
+
+void usage(char const *name) {
+  std::cerr << "usage: " << name
+            << " [--keys KEYS] [--frames N] [--depth N] [--frontier N]"
+               " [--timing fixed|vip] --goal VX=NN|ADDR=NN <rom>\n"
+               "KEYS lists hex keys to try, '-' for no key (default "
+               "-0123456789ABCDEF)\n";
+}
+
+std::optional<std::vector<uint16_t>> parse_keys(std::string_view keys) {
+  std::vector<uint16_t> inputs;
+  for (auto key : keys) {
+    if (key == '-') {
+      inputs.push_back(0);
+      continue;
+    }
+
+    auto digit = std::string_view{"0123456789ABCDEF"}.find(std::toupper(key));
+    if (digit == std::string_view::npos) {
+      return std::nullopt;
+    }
+    inputs.push_back(1 << digit);
+  }
+
+  return inputs;
+}
+
+std::optional<Goal> parse_goal(std::string const &goal) {
+  auto equals = goal.find('=');
+  if (equals == std::string::npos) {
+    return std::nullopt;
+  }
+
+  Goal result;
+  auto target = goal.substr(0, equals);
+  if (target.size() == 2 && std::toupper(target[0]) == 'V') {
+    result.register_goal = true;
+    result.location = std::stoul(target.substr(1), nullptr, 16);
+  } else {
+    result.location = std::stoul(target, nullptr, 0);
+    if (result.location >= Cpu::MEMORY_SIZE) {
+      return std::nullopt;
+    }
+  }
+  result.value = std::stoul(goal.substr(equals + 1), nullptr, 0);
+
+  return result;
+}
+
+std::optional<Options> parse(int argc, char *argv[]) {
+  Options options;
+  options.search.inputs = *parse_keys("-0123456789ABCDEF");
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string_view arg = argv[i];
+
+      if (arg == "--keys" && i + 1 < argc) {
+        auto inputs = parse_keys(argv[++i]);
+        if (!inputs || inputs->empty()) {
+          return std::nullopt;
+        }
+        options.search.inputs = std::move(*inputs);
+      } else if (arg == "--frames" && i + 1 < argc) {
+        options.search.frames_per_input = std::stoul(argv[++i]);
+      } else if (arg == "--depth" && i + 1 < argc) {
+        options.search.depth = std::stoul(argv[++i]);
+      } else if (arg == "--frontier" && i + 1 < argc) {
+        options.search.max_frontier = std::stoul(argv[++i]);
+      } else if (arg == "--timing" && i + 1 < argc) {
+        auto timing = parse_timing(argv[++i]);
+        if (!timing) {
+          return std::nullopt;
+        }
+        options.search.timing = *timing;
+      } else if (arg == "--goal" && i + 1 < argc) {
+        options.goal = parse_goal(argv[++i]);
+        if (!options.goal) {
+          return std::nullopt;
+        }
+      } else if (options.rom.empty() && !arg.starts_with("--")) {
+        options.rom = arg;
+      } else {
+        return std::nullopt;
+      }
+    }
+  } catch (std::exception const &) {
+    return std::nullopt;
+  }
+
+  if (options.rom.empty() || !options.goal) {
+    return std::nullopt;
+  }
+
+  return options;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  auto options = parse(argc, argv);
+  if (!options) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto program = read_program(options->rom);
+  if (!program) {
+    std::cerr << options->rom.string() << ": not a loadable ROM\n";
+    return EXIT_FAILURE;
+  }
+
+  auto result = search(Cpu{*program}, options->search, *options->goal);
+  std::cout << result.explored << " states explored, " << result.duplicates
+            << " duplicates, " << result.traps << " traps\n";
+
+  if (!result.state) {
+    std::cout << "goal not reached\n";
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "goal reached after " << result.inputs.size() << " inputs:";
+  for (auto input : result.inputs) {
+    std::cout << ' ';
+    if (!input) {
+      std::cout << '-';
+    }
+    for (size_t key = 0; key < 0x10; key++) {
+      if (input >> key & 1) {
+        std::cout << "0123456789ABCDEF"[key];
+      }
+    }
+  }
+  std::cout << '\n';
+
+  return EXIT_SUCCESS;
+}
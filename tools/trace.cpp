@@ -0,0 +1,45 @@
+#include "disassembler.hpp"
+#include "trace.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+using namespace chip_8;
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    std::cerr << "usage: " << argv[0] << " <trace>\n";
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream ifstream{argv[1], std::ios::binary};
+  auto records = read_trace(ifstream);
+  if (!records) {
+    std::cerr << argv[1] << ": not a trace dump\n";
+    return EXIT_FAILURE;
+  }
+
+  std::cout << std::hex << std::uppercase << std::setfill('0');
+  for (auto &&record : *records) {
+    Opcode opcode{record.opcode};
+
+    std::cout << std::setw(3) << record.program_counter << "  "
+              << std::setw(4) << record.opcode << "  " << std::setfill(' ')
+              << std::left << std::setw(16)
+              << disassemble(opcode).value_or("???") << std::right
+              << std::setfill('0') << "I=" << std::setw(3) << record.index;
+
+    for (size_t i = 0; i < record.registers.size(); i++) {
+      if (record.changed & (1 << i)) {
+        std::cout << " V" << i << "=" << std::setw(2)
+                  << +record.registers[i];
+      }
+    }
+
+    std::cout << "\n";
+  }
+
+  return EXIT_SUCCESS;
+}